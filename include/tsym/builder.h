@@ -0,0 +1,68 @@
+#ifndef TSYM_BUILDER_H
+#define TSYM_BUILDER_H
+
+#include <cstddef>
+#include <vector>
+#include "var.h"
+
+namespace tsym {
+    class SumBuilder {
+        /* Accumulator for sums with many summands, e.g. assembled in a loop. Other than repeated
+         * calls to Var::operator+=, which simplify the growing sum again for every new summand
+         * and cache all intermediate results, the summands are only collected and simplified
+         * once when the result is requested. Like terms are combined by hashing, both while
+         * accumulating, such that repeated terms don't take up additional memory, and for the
+         * result, such that the overall cost is roughly linear in the number of summands.
+         *
+         * The result is always the same as with repeated operator+=. If only one summand is
+         * simplified depending on the order of summation (e.g. an irrational or a floating point
+         * coefficient), this requires the whole result to be computed one summand after another,
+         * and like terms are only combined while accumulating up to the first such summand. */
+      public:
+        SumBuilder& operator+=(const Var& summand);
+        SumBuilder& operator-=(const Var& summand);
+
+        void reserve(std::size_t n);
+        /* Number of summands added so far, including those combined with like terms: */
+        std::size_t size() const;
+        /* Zero for an empty builder: */
+        Var get() const;
+
+      private:
+        void add(Var::BasePtr summand);
+        void compact();
+
+        std::vector<Var::BasePtr> summands;
+        std::size_t count = 0;
+        /* Number of summands after the last combination of like terms: */
+        std::size_t compacted = 0;
+        bool collectable = true;
+    };
+
+    class ProductBuilder {
+        /* Same as SumBuilder, but for factors. Equal bases are combined by hashing, such that
+         * their exponents are added up only once. A single factor like sqrt(2) or a power of a
+         * trigonometric function requires the whole result to be computed one factor after
+         * another. */
+      public:
+        ProductBuilder& operator*=(const Var& factor);
+        ProductBuilder& operator/=(const Var& factor);
+
+        void reserve(std::size_t n);
+        /* Number of factors added so far, including those combined with equal bases: */
+        std::size_t size() const;
+        /* One for an empty builder: */
+        Var get() const;
+
+      private:
+        void add(Var::BasePtr factor);
+        void compact();
+
+        std::vector<Var::BasePtr> factors;
+        std::size_t count = 0;
+        std::size_t compacted = 0;
+        bool collectable = true;
+    };
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef TSYM_DEFERRED_H
+#define TSYM_DEFERRED_H
+
+#include <memory>
+#include "var.h"
+
+namespace tsym {
+    class DeferredVar {
+        /* Expression that is assembled without any automatic simplification. Arithmetic operations
+         * only record a tree of raw sums, products and powers, where repeated additions or
+         * multiplications are kept as a single operation with many operands. The tree is
+         * simplified once, bottom-up, when the result is requested for the first time, and gives
+         * the same Var as the eager construction by Var operators would have done. Intended for
+         * generated code that builds large expressions before any inspection. Compound assignments
+         * append to the recorded operation in place as long as no other instance shares it, so
+         * prefer e.g. s += t over s = s + t in loops. Concurrent calls to get() are safe. */
+      public:
+        DeferredVar(const Var& value); // NOLINT
+        DeferredVar(int value); // NOLINT
+
+        DeferredVar& operator+=(const DeferredVar& rhs);
+        DeferredVar& operator-=(const DeferredVar& rhs);
+        DeferredVar& operator*=(const DeferredVar& rhs);
+        DeferredVar& operator/=(const DeferredVar& rhs);
+
+        DeferredVar operator-() const;
+
+        /* Simplifies the recorded tree upon the first call: */
+        const Var& get() const;
+
+        friend DeferredVar pow(const DeferredVar& base, const DeferredVar& exp);
+
+      private:
+        enum class Operation : unsigned char { LEAF, SUM, PRODUCT, POWER };
+        struct Node;
+
+        DeferredVar(Operation operation, std::shared_ptr<Node> first, std::shared_ptr<Node> second);
+
+        void append(Operation operation, std::shared_ptr<Node> operand);
+        static const Var& evaluate(Node& node);
+
+        std::shared_ptr<Node> node;
+    };
+
+    DeferredVar operator+(DeferredVar lhs, const DeferredVar& rhs);
+    DeferredVar operator-(DeferredVar lhs, const DeferredVar& rhs);
+    DeferredVar operator*(DeferredVar lhs, const DeferredVar& rhs);
+    DeferredVar operator/(DeferredVar lhs, const DeferredVar& rhs);
+
+    DeferredVar pow(const DeferredVar& base, const DeferredVar& exp);
+}
+
+#endif
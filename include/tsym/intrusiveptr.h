@@ -0,0 +1,116 @@
+#ifndef TSYM_INTRUSIVEPTR_H
+#define TSYM_INTRUSIVEPTR_H
+
+#include <cstddef>
+#include <utility>
+
+namespace tsym {
+    template <class T> class IntrusivePtr {
+        /* Minimal smart pointer to objects that carry their own reference count. The count is
+         * modified by the free functions addRef(T*) and release(T*) found via argument dependent
+         * lookup, which is why T can be an incomplete type as long as these two functions are
+         * declared. Compared to std::shared_ptr, there is neither a separate control block nor a
+         * weak count, and the pointer has the size of a raw pointer. */
+      public:
+        using element_type = T;
+
+        IntrusivePtr() = default;
+        IntrusivePtr(std::nullptr_t) {} // NOLINT
+        /* Pass false as second argument to adopt a reference that has already been acquired: */
+        explicit IntrusivePtr(T* ptr, bool incrementCount = true)
+            : ptr(ptr)
+        {
+            if (ptr != nullptr && incrementCount)
+                addRef(ptr);
+        }
+
+        IntrusivePtr(const IntrusivePtr& other)
+            : IntrusivePtr(other.ptr)
+        {}
+
+        IntrusivePtr(IntrusivePtr&& other) noexcept
+            : ptr(std::exchange(other.ptr, nullptr))
+        {}
+
+        IntrusivePtr& operator=(const IntrusivePtr& rhs)
+        {
+            IntrusivePtr(rhs).swap(*this);
+
+            return *this;
+        }
+
+        IntrusivePtr& operator=(IntrusivePtr&& rhs) noexcept
+        {
+            IntrusivePtr(std::move(rhs)).swap(*this);
+
+            return *this;
+        }
+
+        ~IntrusivePtr()
+        {
+            if (ptr != nullptr)
+                release(ptr);
+        }
+
+        T* get() const noexcept
+        {
+            return ptr;
+        }
+
+        T& operator*() const noexcept
+        {
+            return *ptr;
+        }
+
+        T* operator->() const noexcept
+        {
+            return ptr;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return ptr != nullptr;
+        }
+
+        void reset() noexcept
+        {
+            IntrusivePtr().swap(*this);
+        }
+
+        /* Gives up ownership without releasing the reference, counterpart of the adopting constructor: */
+        T* detach() noexcept
+        {
+            return std::exchange(ptr, nullptr);
+        }
+
+        void swap(IntrusivePtr& other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+        }
+
+      private:
+        T* ptr = nullptr;
+    };
+
+    template <class T, class U> bool operator==(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs)
+    {
+        return lhs.get() == rhs.get();
+    }
+
+    template <class T, class U> bool operator!=(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs)
+    {
+        return lhs.get() != rhs.get();
+    }
+
+    template <class T> bool operator==(const IntrusivePtr<T>& lhs, std::nullptr_t)
+    {
+        return lhs.get() == nullptr;
+    }
+
+    template <class T> bool operator!=(const IntrusivePtr<T>& lhs, std::nullptr_t)
+    {
+        return lhs.get() != nullptr;
+    }
+}
+
+#endif
@@ -27,11 +27,12 @@ namespace tsym {
         virtual void error(const Message& msg) const;
         virtual void critical(const Message& msg) const;
 
+        /* Both functions can be called concurrently. The instance is swapped and read with the
+         * atomic shared_ptr functions, which aren't necessarily lock-free (libstdc++ guards them
+         * with a pool of mutexes). The returned snapshot keeps the logger alive even if another
+         * thread replaces it in the meantime: */
         static void setInstance(std::unique_ptr<const Logger> logger);
-        static const Logger& getInstance();
-
-      private:
-        static std::unique_ptr<const Logger> instance;
+        static std::shared_ptr<const Logger> getInstance();
     };
 }
 
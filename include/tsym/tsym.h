@@ -1,7 +1,9 @@
 #ifndef TSYM_ALL_H
 #define TSYM_ALL_H
 
+#include "builder.h"
 #include "constants.h"
+#include "deferred.h"
 #include "functions.h"
 #include "logger.h"
 #include "plaintextprintengine.h"
@@ -4,9 +4,13 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include "intrusiveptr.h"
 
 namespace tsym {
     class Base;
+
+    void addRef(const Base* ptr) noexcept;
+    void release(const Base* ptr) noexcept;
 }
 
 namespace tsym {
@@ -18,7 +22,15 @@ namespace tsym {
          * multiplication, division). As this class is not more than a wrapper, all other
          * functionality (differentiation, simplification etc.) is invoked by calling free
          * functions. Var objects holding numbers can be explicitely converted to plain double or,
-         * if they fit, into integers. */
+         * if they fit, into integers.
+         *
+         * The binary operators don't simplify their result right away, but record a chain of
+         * operands, such that e.g. a + b - c + d is simplified as one flat sum upon first use,
+         * without intermediate sums and their cache entries. The result is the same as with
+         * stepwise simplification. It's computed with the options and caches of the context that
+         * was current when the operator was applied, which must hence outlive the unevaluated
+         * object. The first use can happen concurrently. Compound assignments simplify
+         * immediately. */
       public:
         enum class Sign : bool { POSITIVE = true };
         enum class Type { SYMBOL, INT, FRACTION, DOUBLE, CONSTANT, UNDEFINED, FUNCTION, SUM, PRODUCT, POWER };
@@ -38,6 +50,11 @@ namespace tsym {
         Var& operator-=(const Var& rhs);
         Var& operator*=(const Var& rhs);
         Var& operator/=(const Var& rhs);
+        /* Temporaries are moved into the result: */
+        Var& operator+=(Var&& rhs);
+        Var& operator-=(Var&& rhs);
+        Var& operator*=(Var&& rhs);
+        Var& operator/=(Var&& rhs);
 
         const Var& operator+() const;
         Var operator-() const;
@@ -51,12 +68,31 @@ namespace tsym {
 
       public:
         /* To be used internally: */
-        using BasePtr = std::shared_ptr<const Base>;
+        using BasePtr = IntrusivePtr<const Base>;
         explicit Var(BasePtr ptr);
-        const BasePtr& get() const;
+        const BasePtr& get() const&;
+        /* Moves the handle out of a temporary: */
+        BasePtr get() &&;
 
       private:
+        enum class Operation : bool { SUM, PRODUCT };
+        struct Chain;
+
+        void append(Operation operation, BasePtr operand);
+        static const BasePtr& evaluate(Chain& chain);
+
+        friend Var operator+(Var lhs, const Var& rhs);
+        friend Var operator-(Var lhs, const Var& rhs);
+        friend Var operator*(Var lhs, const Var& rhs);
+        friend Var operator/(Var lhs, const Var& rhs);
+        friend Var operator+(Var lhs, Var&& rhs);
+        friend Var operator-(Var lhs, Var&& rhs);
+        friend Var operator*(Var lhs, Var&& rhs);
+        friend Var operator/(Var lhs, Var&& rhs);
+
         BasePtr rep;
+        /* Operands of a sum or product that isn't simplified yet, shared by copies: */
+        std::shared_ptr<Chain> chain;
     };
 
     bool operator==(const Var& lhs, const Var& rhs);
@@ -66,6 +102,12 @@ namespace tsym {
     Var operator-(Var lhs, const Var& rhs);
     Var operator*(Var lhs, const Var& rhs);
     Var operator/(Var lhs, const Var& rhs);
+    /* The left hand side is taken by value, so temporaries on either side are moved into the
+     * result: */
+    Var operator+(Var lhs, Var&& rhs);
+    Var operator-(Var lhs, Var&& rhs);
+    Var operator*(Var lhs, Var&& rhs);
+    Var operator/(Var lhs, Var&& rhs);
 
     std::ostream& operator<<(std::ostream& stream, const Var& rhs);
     std::ostream& operator<<(std::ostream& stream, const Var::Type& rhs);
@@ -1,6 +1,8 @@
 
 #include "base.h"
+#include <boost/algorithm/cxx11/all_of.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/range/adaptors.hpp>
 #include <sstream>
 #include <utility>
@@ -18,19 +20,151 @@
 #include "product.h"
 #include "symbolmap.h"
 #include "undefined.h"
+#include "uniquetable.h"
+
+namespace tsym {
+    namespace {
+        namespace lazy {
+            constexpr std::uint16_t numericEvalKnown = 1u << 0u;
+            constexpr std::uint16_t positiveKnown = 1u << 1u;
+            constexpr std::uint16_t positive = 1u << 2u;
+            constexpr std::uint16_t negativeKnown = 1u << 3u;
+            constexpr std::uint16_t negative = 1u << 4u;
+            constexpr std::uint16_t constKnown = 1u << 5u;
+            constexpr std::uint16_t constant = 1u << 6u;
+            constexpr std::uint16_t weaklyReferenced = 1u << 7u;
+            constexpr std::uint16_t numericEvalIsNumber = 1u << 8u;
+            constexpr unsigned unknownComplexity = std::numeric_limits<unsigned>::max();
+        }
+
+        size_t combinedHash(Base::Kind kind, size_t leafHash, const BasePtrList& operands)
+        {
+            size_t seed = 0;
+
+            boost::hash_combine(seed, static_cast<unsigned char>(kind));
+            boost::hash_combine(seed, leafHash);
+
+            for (const auto& op : operands)
+                boost::hash_combine(seed, op->hash());
+
+            return seed;
+        }
+
+        std::uint64_t combinedSymbolBits(Base::Kind kind, size_t hash, const BasePtrList& operands)
+        {
+            std::uint64_t bits = 0;
+
+            if (kind == Base::Kind::SYMBOL)
+                return std::uint64_t{1} << (hash % 64);
+
+            for (const auto& op : operands)
+                bits |= op->symbolBloom();
+
+            return bits;
+        }
+    }
+}
 
-tsym::Base::Base(const char* typeString)
-    : Base(typeString, {})
+tsym::Base::Base(Kind kind, size_t leafHash, bool interned, std::uint64_t nameKey)
+    : typeKind(kind)
+    , interned(interned)
+    , hashValue(combinedHash(kind, leafHash, ops))
+    , symbolBits(combinedSymbolBits(kind, hashValue, ops))
+    , nameKey(nameKey)
 {}
 
-tsym::Base::Base(const char* typeString, BasePtrList operands)
+tsym::Base::Base(Kind kind, BasePtrList operands, size_t leafHash, std::uint64_t nameKey)
     : ops(std::move(operands))
-    , typeString(typeString)
+    , typeKind(kind)
+    , interned(boost::algorithm::all_of(ops, std::mem_fn(&Base::isInterned)))
+    , hashValue(combinedHash(kind, leafHash, ops))
+    , symbolBits(combinedSymbolBits(kind, hashValue, ops))
+    , nameKey(nameKey)
 {}
 
+tsym::Base::~Base()
+{
+    delete lazyNumericEval.load(std::memory_order_relaxed);
+}
+
+std::optional<tsym::Number> tsym::Base::numericEval() const
+{
+    /* The flags are the only source of truth for whether the evaluation is known. The pointer is
+     * published before the flags are release-set, so it can't be observed as null afterwards. */
+    const std::uint16_t flags = lazyFlags.load(std::memory_order_acquire);
+
+    if ((flags & lazy::numericEvalIsNumber) != 0)
+        return *lazyNumericEval.load(std::memory_order_acquire);
+    else if ((flags & lazy::numericEvalKnown) != 0)
+        return std::nullopt;
+
+    const std::optional<Number> result = computeNumericEval();
+
+    if (result) {
+        const Number* expected = nullptr;
+        const auto* computed = new Number(*result);
+
+        if (!lazyNumericEval.compare_exchange_strong(expected, computed, std::memory_order_acq_rel))
+            /* Another thread was faster. */
+            delete computed;
+
+        lazyFlags.fetch_or(lazy::numericEvalKnown | lazy::numericEvalIsNumber, std::memory_order_release);
+    } else
+        lazyFlags.fetch_or(lazy::numericEvalKnown, std::memory_order_release);
+
+    return result;
+}
+
+bool tsym::Base::isPositive() const
+{
+    return lazyFlag(lazy::positiveKnown, lazy::positive, &Base::computeIsPositive);
+}
+
+bool tsym::Base::isNegative() const
+{
+    return lazyFlag(lazy::negativeKnown, lazy::negative, &Base::computeIsNegative);
+}
+
+unsigned tsym::Base::complexity() const
+{
+    unsigned result = lazyComplexity.load(std::memory_order_relaxed);
+
+    if (result == lazy::unknownComplexity) {
+        result = computeComplexity();
+        lazyComplexity.store(result, std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+bool tsym::Base::isConst() const
+{
+    return lazyFlag(lazy::constKnown, lazy::constant, &Base::computeIsConst);
+}
+
+bool tsym::Base::lazyFlag(std::uint16_t knownBit, std::uint16_t valueBit, bool (Base::*compute)() const) const
+{
+    const std::uint16_t flags = lazyFlags.load(std::memory_order_relaxed);
+
+    if (flags & knownBit)
+        return flags & valueBit;
+
+    const bool result = (this->*compute)();
+
+    lazyFlags.fetch_or(result ? knownBit | valueBit : knownBit, std::memory_order_relaxed);
+
+    return result;
+}
+
 bool tsym::Base::isEqual(const Base& other) const
 {
-    return this == &other || isEqualDifferentBase(other);
+    if (this == &other)
+        return true;
+    else if (interned && other.interned)
+        /* Structurally equal nodes would have been merged into one instance upon creation. */
+        return false;
+    else
+        return isEqualDifferentBase(other);
 }
 
 bool tsym::Base::isDifferent(const Base& other) const
@@ -42,7 +176,9 @@ bool tsym::Base::has(const Base& other) const
 {
     using boost::adaptors::indirected;
 
-    if (isEqual(other))
+    if (!mightHave(other))
+        return false;
+    else if (isEqual(other))
         return true;
     else if (!ops.empty())
         return boost::algorithm::any_of(ops | indirected, [&other](const auto& item) { return item.has(other); });
@@ -50,7 +186,7 @@ bool tsym::Base::has(const Base& other) const
         return false;
 }
 
-bool tsym::Base::isConst() const
+bool tsym::Base::computeIsConst() const
 {
     if (ops.empty())
         return false;
@@ -133,7 +269,7 @@ const tsym::Name& tsym::Base::name() const
 
 tsym::BasePtr tsym::Base::clone() const
 {
-    return shared_from_this();
+    return BasePtr{this};
 }
 
 tsym::BasePtr tsym::Base::normal() const
@@ -146,14 +282,13 @@ tsym::BasePtr tsym::Base::normal() const
 
 tsym::BasePtr tsym::Base::normalViaCache() const
 {
-    static RegisteredCache<BasePtr, BasePtr> cache;
-    static auto& map(cache.map);
+    TSYM_CACHE_STORAGE RegisteredCache<BasePtr, BasePtr> cache("normal");
     const BasePtr key = clone();
 
-    if (const auto lookup = map.find(key); lookup != cend(map))
-        return lookup->second;
+    if (const auto lookup = cache.find(key))
+        return *lookup;
 
-    return map.insert({key, normalWithoutCache()})->second;
+    return cache.insert(key, normalWithoutCache());
 }
 
 tsym::BasePtr tsym::Base::normalWithoutCache() const
@@ -182,9 +317,58 @@ const tsym::BasePtrList& tsym::Base::operands() const
     return ops;
 }
 
+tsym::Base::Kind tsym::Base::kind() const
+{
+    return typeKind;
+}
+
 std::string_view tsym::Base::typeStr() const
 {
-    return typeString;
+    switch (typeKind) {
+        case Kind::NUMERIC:
+            return typestring::numeric;
+        case Kind::CONSTANT:
+            return typestring::constant;
+        case Kind::SYMBOL:
+            return typestring::symbol;
+        case Kind::UNDEFINED:
+            return typestring::undefined;
+        case Kind::FUNCTION:
+            return typestring::function;
+        case Kind::POWER:
+            return typestring::power;
+        case Kind::PRODUCT:
+            return typestring::product;
+        case Kind::SUM:
+            return typestring::sum;
+    }
+
+    return typestring::undefined;
+}
+
+bool tsym::Base::isInterned() const
+{
+    return interned;
+}
+
+size_t tsym::Base::hash() const
+{
+    return hashValue;
+}
+
+std::uint64_t tsym::Base::symbolBloom() const
+{
+    return symbolBits;
+}
+
+bool tsym::Base::mightHave(const Base& other) const
+{
+    return (other.symbolBits & ~symbolBits) == 0;
+}
+
+std::uint64_t tsym::Base::nameOrderKey() const
+{
+    return nameKey;
 }
 
 bool tsym::Base::isEqualByTypeAndOperands(const Base& other) const
@@ -207,6 +391,70 @@ void tsym::Base::setDebugString()
 #endif
 }
 
+void tsym::addRef(const Base* ptr) noexcept
+{
+#ifdef TSYM_NONATOMIC_REFCOUNT
+    ++ptr->refCount;
+#else
+    ptr->refCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+void tsym::release(const Base* ptr) noexcept
+{
+#ifdef TSYM_NONATOMIC_REFCOUNT
+    if (--ptr->refCount == 0)
+#else
+    if (ptr->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+#endif
+    {
+        /* The node is removed from the unique table while still being fully intact, such that
+         * concurrent lookups can safely compare against it until then: */
+        if (ptr->interned)
+            unintern(*ptr);
+
+        if ((ptr->lazyFlags.load(std::memory_order_relaxed) & lazy::weaklyReferenced) != 0)
+            detail::purgeWeakCacheEntries(*ptr);
+
+        delete ptr;
+    }
+}
+
+bool tsym::tryAddRef(const Base* ptr) noexcept
+{
+#ifdef TSYM_NONATOMIC_REFCOUNT
+    if (ptr->refCount == 0)
+        return false;
+
+    ++ptr->refCount;
+
+    return true;
+#else
+    unsigned count = ptr->refCount.load(std::memory_order_relaxed);
+
+    do
+        if (count == 0)
+            return false;
+    while (!ptr->refCount.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+
+    return true;
+#endif
+}
+
+void tsym::releaseNonLast(const Base* ptr) noexcept
+{
+#ifdef TSYM_NONATOMIC_REFCOUNT
+    --ptr->refCount;
+#else
+    ptr->refCount.fetch_sub(1, std::memory_order_relaxed);
+#endif
+}
+
+void tsym::markWeaklyReferenced(const Base* ptr) noexcept
+{
+    ptr->lazyFlags.fetch_or(lazy::weaklyReferenced, std::memory_order_relaxed);
+}
+
 std::ostream& tsym::operator<<(std::ostream& stream, const Base& arg)
 {
     auto engine = PlaintextPrintEngine{stream};
@@ -1,7 +1,9 @@
 #ifndef TSYM_BASE_H
 #define TSYM_BASE_H
 
-#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -15,9 +17,9 @@ namespace tsym {
 }
 
 namespace tsym {
-    class Base : public std::enable_shared_from_this<const Base> {
+    class Base {
         /* Abstract base class for all mathematical classes (Power, Product etc.). References to
-         * this class are managed by reference counting inside of the BasePtr type.
+         * this class are managed by an intrusive reference count, see BasePtr.
          *
          * The Base class and its subclasses can be understood as an implementation of the GoF
          * Composite pattern, where all objects are immutable (thus, no adding/removing of
@@ -30,27 +32,24 @@ namespace tsym {
          * Symbol or Constant. This clutters the interface a bit, but provides easy access to all
          * information without using casts. */
       public:
+        /* Compact tag for the concrete type of an instance, i.e., type checks and dispatch are
+         * based on integral comparisons. Trigonometric and Logarithm share FUNCTION: */
+        enum class Kind : unsigned char { NUMERIC, CONSTANT, SYMBOL, UNDEFINED, FUNCTION, POWER, PRODUCT, SUM };
+
         Base(const Base&) = delete;
         Base& operator=(const Base&) = delete;
         Base(Base&&) = delete;
         Base& operator=(Base&&) = delete;
-        virtual ~Base() = default;
+        virtual ~Base();
 
         virtual bool isEqualDifferentBase(const Base& other) const = 0;
-        virtual std::optional<Number> numericEval() const = 0;
         virtual Fraction normal(SymbolMap& map) const = 0;
         virtual BasePtr diffWrtSymbol(const Base& symbol) const = 0;
-        /* If unclear or zero, the following two methods shall return false: */
-        virtual bool isPositive() const = 0;
-        virtual bool isNegative() const = 0;
-        virtual unsigned complexity() const = 0;
-        virtual size_t hash() const = 0;
 
+        /* Interned instances are compared by identity, everything else structurally: */
         virtual bool isEqual(const Base& other) const;
         virtual bool isDifferent(const Base& other) const;
         virtual bool has(const Base& other) const;
-        /* Returns true for (composites of) Numerics or num. powers, nothing else: */
-        virtual bool isConst() const;
         virtual BasePtr numericTerm() const;
         virtual BasePtr nonNumericTerm() const;
         /* For the following two methods, Constant types are treated as variables, only Numerics
@@ -69,30 +68,89 @@ namespace tsym {
         /* Returns Symbol/Constant/Function name, an empty Name otherwise: */
         virtual const Name& name() const;
 
+        /* The following five properties are computed by the private virtual methods below upon
+         * the first request and stored in the instance afterwards: */
+        std::optional<Number> numericEval() const;
+        /* If unclear or zero, the following two methods shall return false: */
+        bool isPositive() const;
+        bool isNegative() const;
+        unsigned complexity() const;
+        /* Returns true for (composites of) Numerics or num. powers, nothing else: */
+        bool isConst() const;
+
         BasePtr clone() const;
         BasePtr normal() const;
         BasePtr diff(const Base& symbol) const;
         const BasePtrList& operands() const;
+        Kind kind() const;
         std::string_view typeStr() const;
+        /* The structural hash is computed bottom-up once during construction: */
+        size_t hash() const;
+        /* Returns false for Numerics with a floating point value (they are compared with a
+         * tolerance) and composites containing them. All other nodes are unique, see intern(...): */
+        bool isInterned() const;
+        /* Summary of all contained Symbols as a 64 bit Bloom filter, which is zero if and only if
+         * the expression is free of Symbols. It's used to skip subtrees in has, subst, coeff etc.: */
+        std::uint64_t symbolBloom() const;
+        /* Returns false only if the other expression can't be part of this one: */
+        bool mightHave(const Base& other) const;
+        /* The orderKey of the name, zero for types without a name. It settles most comparisons of
+         * names in the canonical order without touching the strings, see order.cpp: */
+        std::uint64_t nameOrderKey() const;
 
       protected:
-        explicit Base(const char* typeString);
-        Base(const char* typeString, BasePtrList operands);
+        /* The leaf hash must contain every information that identifies an instance apart from its
+         * type and its operands, e.g. a Symbol name or a Function name: */
+        Base(Kind kind, size_t leafHash, bool interned = true, std::uint64_t nameKey = 0);
+        Base(Kind kind, BasePtrList operands, size_t leafHash = 0, std::uint64_t nameKey = 0);
 
         bool isEqualByTypeAndOperands(const Base& other) const;
         void setDebugString();
 
         const BasePtrList ops{};
 
-        /* Empty struct for using make_shared for subclasses that shall not be created directly,
+        /* Empty struct for subclasses with public constructors that shall not be called directly,
          * but only via their static creation methods. */
         struct CtorKey {};
 
       private:
+        friend void addRef(const Base* ptr) noexcept;
+        friend void release(const Base* ptr) noexcept;
+        friend bool tryAddRef(const Base* ptr) noexcept;
+        friend void releaseNonLast(const Base* ptr) noexcept;
+        friend void markWeaklyReferenced(const Base* ptr) noexcept;
+        /* Restores persisted nodes without simplifying them again, see cachecodec.cpp: */
+        friend class ExprDecoder;
+
+        virtual std::optional<Number> computeNumericEval() const = 0;
+        virtual bool computeIsPositive() const = 0;
+        virtual bool computeIsNegative() const = 0;
+        virtual unsigned computeComplexity() const = 0;
+        virtual bool computeIsConst() const;
+
+        bool lazyFlag(std::uint16_t knownBit, std::uint16_t valueBit, bool (Base::*compute)() const) const;
         BasePtr normalViaCache() const;
         BasePtr normalWithoutCache() const;
 
-        const std::string_view typeString;
+        const Kind typeKind;
+        const bool interned;
+        const size_t hashValue;
+        const std::uint64_t symbolBits;
+        const std::uint64_t nameKey;
+
+#ifdef TSYM_NONATOMIC_REFCOUNT
+        mutable unsigned refCount = 0;
+#else
+        mutable std::atomic<unsigned> refCount{0};
+#endif
+
+        /* Storage for the lazily computed properties, concurrent evaluation is harmless, as the
+         * results are deterministic. The numeric evaluation is heap-allocated once it's known to
+         * be non-empty, to not bloat nodes that never need it. The flags also hold the mark for
+         * weak cache references: */
+        mutable std::atomic<std::uint16_t> lazyFlags{0};
+        mutable std::atomic<unsigned> lazyComplexity{std::numeric_limits<unsigned>::max()};
+        mutable std::atomic<const Number*> lazyNumericEval{nullptr};
 
 #ifdef TSYM_WITH_DEBUG_STRINGS
         /* A member to be accessed by a gdb pretty printing plugin. As the class is immutable,
@@ -1,7 +1,6 @@
 
 #include "basefct.h"
 #include "base.h"
-#include "basetypestr.h"
 #include "number.h"
 #include "numberfct.h"
 
@@ -34,58 +33,49 @@ bool tsym::isZero(const Base& expr)
     return isNumeric(expr) && isEqual<0>(expr);
 }
 
-namespace tsym {
-    namespace {
-        bool areTypeStrEqual(const Base& expr, const char* predefinedTyepStr)
-        {
-            return expr.typeStr().data() == predefinedTyepStr;
-        }
-    }
-}
-
 bool tsym::isConstant(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::constant);
+    return expr.kind() == Base::Kind::CONSTANT;
 }
 
 bool tsym::isFunction(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::function);
+    return expr.kind() == Base::Kind::FUNCTION;
 }
 
 bool tsym::isNumeric(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::numeric);
+    return expr.kind() == Base::Kind::NUMERIC;
 }
 
 bool tsym::isPower(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::power);
+    return expr.kind() == Base::Kind::POWER;
 }
 
 bool tsym::isProduct(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::product);
+    return expr.kind() == Base::Kind::PRODUCT;
 }
 
 bool tsym::isSum(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::sum);
+    return expr.kind() == Base::Kind::SUM;
 }
 
 bool tsym::isSymbol(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::symbol);
+    return expr.kind() == Base::Kind::SYMBOL;
 }
 
 bool tsym::isUndefined(const Base& expr)
 {
-    return areTypeStrEqual(expr, typestring::undefined);
+    return expr.kind() == Base::Kind::UNDEFINED;
 }
 
 bool tsym::sameType(const Base& first, const Base& second)
 {
-    return first.typeStr().data() == second.typeStr().data();
+    return first.kind() == second.kind();
 }
 
 bool tsym::isNumericPower(const Base& expr)
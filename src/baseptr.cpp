@@ -1,6 +1,5 @@
 
 #include "baseptr.h"
-#include <boost/functional/hash.hpp>
 #include "base.h"
 #include "plaintextprintengine.h"
 #include "printer.h"
@@ -16,12 +15,7 @@ std::ostream& tsym::operator<<(std::ostream& stream, const BasePtr& ptr)
 
 size_t tsym::hash_value(const BasePtr& ptr)
 {
-    size_t seed = 0;
-
-    boost::hash_combine(seed, ptr->typeStr());
-    boost::hash_combine(seed, ptr->hash());
-
-    return seed;
+    return ptr->hash();
 }
 
 size_t std::hash<tsym::BasePtr>::operator()(const tsym::BasePtr& ptr) const
@@ -2,11 +2,24 @@
 #define TSYM_BASEPTR_H
 
 #include <functional>
-#include <memory>
+#include <iosfwd>
+#include "intrusiveptr.h"
 
 namespace tsym {
     class Base;
-    using BasePtr = std::shared_ptr<const Base>;
+    /* Reference counted handle to immutable expression nodes, the count is stored in Base: */
+    using BasePtr = IntrusivePtr<const Base>;
+
+    void addRef(const Base* ptr) noexcept;
+    void release(const Base* ptr) noexcept;
+    /* Increments the reference count only if it's non-zero, i.e., if the node isn't about to be
+     * destroyed. Returns true on success, the caller then owns a reference: */
+    bool tryAddRef(const Base* ptr) noexcept;
+    /* Decrements a reference count that is known to stay positive, i.e., never destroys the node: */
+    void releaseNonLast(const Base* ptr) noexcept;
+    /* Flags the node as referenced by weak cache entries, which are then purged right before the
+     * node is destroyed, see cache.h: */
+    void markWeaklyReferenced(const Base* ptr) noexcept;
 
     /* Necessary to ensure that boosts hash specialisations for e.g. standard containers work as
      * expected: The hash is implemented in terms of the pointee, not the pointer itself. This can
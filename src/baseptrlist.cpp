@@ -5,7 +5,17 @@
 #include "plaintextprintengine.h"
 #include "printer.h"
 
+size_t tsym::hash_value(const BasePtrList& list)
+{
+    return boost::hash_range(cbegin(list), cend(list));
+}
+
 std::ostream& tsym::operator<<(std::ostream& stream, const BasePtrList& items)
+{
+    return stream << BasePtrListView(items);
+}
+
+std::ostream& tsym::operator<<(std::ostream& stream, const BasePtrListView& items)
 {
     PlaintextPrintEngine engine(stream);
 
@@ -14,7 +24,7 @@ std::ostream& tsym::operator<<(std::ostream& stream, const BasePtrList& items)
     for (const auto& item : items) {
         print(engine, *item);
 
-        if (&item != &*(prev(end(items))))
+        if (&item != &items.back())
             stream << "   ";
     }
 
@@ -25,7 +35,7 @@ std::ostream& tsym::operator<<(std::ostream& stream, const BasePtrList& items)
 
 size_t std::hash<tsym::BasePtrList>::operator()(const tsym::BasePtrList& list) const
 {
-    return boost::hash<tsym::BasePtrList>{}(list);
+    return tsym::hash_value(list);
 }
 
 bool std::equal_to<tsym::BasePtrList>::operator()(const tsym::BasePtrList& lhs, const tsym::BasePtrList& rhs) const
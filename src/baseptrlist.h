@@ -1,13 +1,36 @@
 #ifndef TSYM_BASEPTRLIST_H
 #define TSYM_BASEPTRLIST_H
 
-#include <list>
+#include <boost/container/small_vector.hpp>
+#include <boost/range/iterator_range_core.hpp>
+#include <memory>
+#include <utility>
 #include "baseptr.h"
 
 namespace tsym {
-    using BasePtrList = std::list<BasePtr>;
+    /* Contiguous operand storage, most expressions have at most four operands that are stored
+     * inline without additional heap allocation. Subranges (e.g. all but the first item) are
+     * passed around as non-owning views. The explicit standard allocator makes std an associated
+     * namespace, such that unqualified begin/end/next etc. are found by argument dependent lookup. */
+    using BasePtrList = boost::container::small_vector<BasePtr, 4, std::allocator<BasePtr>>;
+    using BasePtrListView = boost::iterator_range<BasePtrList::const_iterator>;
+
+    /* Other than a braced initializer list, whose items can only be copied, rvalue arguments are
+     * moved into the result, and lvalues are copied only once: */
+    template <class... T> BasePtrList makeList(T&&... items)
+    {
+        BasePtrList list;
+
+        list.reserve(sizeof...(T));
+        (list.emplace_back(std::forward<T>(items)), ...);
+
+        return list;
+    }
+
+    size_t hash_value(const BasePtrList& list);
 
     std::ostream& operator<<(std::ostream& stream, const BasePtrList& items);
+    std::ostream& operator<<(std::ostream& stream, const BasePtrListView& items);
 }
 
 namespace std {
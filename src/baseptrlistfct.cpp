@@ -12,31 +12,22 @@
 #include "product.h"
 #include "sum.h"
 
-tsym::BasePtrList tsym::join(BasePtr&& first, BasePtrList&& second)
+bool tsym::areEqual(BasePtrListView list1, BasePtrListView list2)
 {
-    second.push_front(std::move(first));
-
-    return std::move(second);
-}
-
-tsym::BasePtrList tsym::join(BasePtrList&& first, BasePtrList&& second)
-{
-    first.splice(end(first), std::move(second));
-
-    return std::move(first);
+    return boost::equal(list1, list2, [](const auto& bp1, const auto& bp2) { return bp1->isEqual(*bp2); });
 }
 
-bool tsym::areEqual(const BasePtrList& list1, const BasePtrList& list2)
+bool tsym::isPair(BasePtrListView list, const Base& first, const Base& second)
 {
-    return boost::equal(list1, list2, [](const auto& bp1, const auto bp2) { return bp1->isEqual(*bp2); });
+    return list.size() == 2 && list.front()->isEqual(first) && list.back()->isEqual(second);
 }
 
-tsym::BasePtrList tsym::rest(BasePtrList list)
+tsym::BasePtrListView tsym::rest(BasePtrListView list)
 {
     if (list.empty())
         TSYM_WARNING("Requesting rest of an empty list!");
     else
-        list.pop_front();
+        list.drop_front();
 
     return list;
 }
@@ -110,28 +101,22 @@ namespace tsym {
             scalar = scalarFactors.empty() ? Numeric::one() : Product::create(scalarFactors);
         }
 
-        BasePtr expandProductOf(BasePtrList& sums)
-        /* Recursively expands a the sum terms of a product, e.g. (a + b)*(c + d) = a*c + a*d + b*c +
+        BasePtr expandProductOf(const BasePtrList& sums)
+        /* Successively expands a the sum terms of a product, e.g. (a + b)*(c + d) = a*c + a*d + b*c +
          * b*d. */
         {
-            const BasePtr first(sums.front());
-            BasePtrList summands;
-            BasePtr second;
-
-            sums.pop_front();
-
-            if (sums.empty())
-                return first;
+            BasePtr product(sums.front());
 
-            second = sums.front();
-            sums.pop_front();
+            for (const auto& second : rest(sums)) {
+                BasePtrList summands;
 
-            for (const auto& item : first->operands())
-                summands.push_back(Product::create(item, second)->expand());
+                for (const auto& item : product->operands())
+                    summands.push_back(Product::create(item, second)->expand());
 
-            sums.push_front(Sum::create(summands));
+                product = Sum::create(summands);
+            }
 
-            return expandProductOf(sums);
+            return product;
         }
 
         BasePtr expandProductOf(const BasePtr& scalar, const Base& sum)
@@ -152,15 +137,13 @@ namespace tsym {
 
 tsym::BasePtr tsym::expandAsProduct(const BasePtrList& list)
 {
-    static RegisteredCache<BasePtrList, BasePtr> cache;
-    static auto& map(cache.map);
-    const auto lookup = map.find(list);
+    TSYM_CACHE_STORAGE RegisteredCache<BasePtrList, BasePtr> cache("expandAsProduct");
     BasePtr expanded;
     BasePtrList sums;
     BasePtr scalar;
 
-    if (lookup != cend(map))
-        return lookup->second;
+    if (const auto lookup = cache.find(list))
+        return *lookup;
 
     defScalarAndSums(list, scalar, sums);
 
@@ -175,7 +158,7 @@ tsym::BasePtr tsym::expandAsProduct(const BasePtrList& list)
             expanded = Product::create(scalar, secondFactor);
     }
 
-    return map.insert({list, std::move(expanded)})->second;
+    return cache.insert(list, std::move(expanded));
 }
 
 void tsym::subst(BasePtrList& list, const Base& from, const BasePtr& to)
@@ -188,6 +171,8 @@ tsym::BasePtrList tsym::subst(const BasePtrList& list, const Base& from, const B
 {
     BasePtrList res;
 
+    res.reserve(list.size());
+
     for (const auto& item : list)
         res.push_back(item->subst(from, to));
 
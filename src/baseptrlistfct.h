@@ -5,14 +5,13 @@
 #include "baseptrlist.h"
 
 namespace tsym {
-    BasePtrList join(BasePtr&& first, BasePtrList&& second);
-    BasePtrList join(BasePtrList&& first, BasePtrList&& second);
-
     /* Evaluates equality by comparing the dereferenced items: */
-    bool areEqual(const BasePtrList& list1, const BasePtrList& list2);
+    bool areEqual(BasePtrListView list1, BasePtrListView list2);
+    /* Same as areEqual with a list of the two given items, without constructing it: */
+    bool isPair(BasePtrListView list, const Base& first, const Base& second);
 
-    /* Copies the given container and removes the first element: */
-    BasePtrList rest(BasePtrList list);
+    /* Returns a view on all but the first element, the argument must outlive the result: */
+    BasePtrListView rest(BasePtrListView list);
 
     /* Shortcuts to STL algorithm calls: */
     bool hasUndefinedElements(const BasePtrList& list);
@@ -0,0 +1,138 @@
+
+#include "builder.h"
+#include <algorithm>
+#include "baseptrlist.h"
+#include "numeric.h"
+#include "power.h"
+#include "product.h"
+#include "productsimpl.h"
+#include "sum.h"
+#include "sumsimpl.h"
+
+namespace tsym {
+    namespace {
+        /* Pending operands are combined once there are at least this many of them and twice as many
+         * as after the previous combination, which keeps the overall cost linear: */
+        constexpr std::size_t minCompactionSize = 64;
+
+        bool needsCompaction(std::size_t size, std::size_t compacted)
+        {
+            return size >= std::max(minCompactionSize, 2 * compacted);
+        }
+    }
+}
+
+tsym::SumBuilder& tsym::SumBuilder::operator+=(const Var& summand)
+{
+    add(summand.get());
+
+    return *this;
+}
+
+tsym::SumBuilder& tsym::SumBuilder::operator-=(const Var& summand)
+{
+    add(Product::minus(summand.get()));
+
+    return *this;
+}
+
+void tsym::SumBuilder::reserve(std::size_t n)
+{
+    summands.reserve(n);
+}
+
+std::size_t tsym::SumBuilder::size() const
+{
+    return count;
+}
+
+tsym::Var tsym::SumBuilder::get() const
+{
+    if (summands.empty())
+        return Var(Numeric::zero());
+
+    return Var(Sum::createLikeStepwise(BasePtrList(cbegin(summands), cend(summands))));
+}
+
+void tsym::SumBuilder::add(Var::BasePtr summand)
+{
+    summands.push_back(std::move(summand));
+    ++count;
+
+    if (collectable && needsCompaction(summands.size(), compacted))
+        compact();
+}
+
+void tsym::SumBuilder::compact()
+/* The combined summands add up to the same result in any order, so they can stand in for the
+ * original ones. This is no longer the case after the first summand that isn't collectable: */
+{
+    const BasePtrList pending(cbegin(summands), cend(summands));
+
+    if (!canCollectByTerm(pending)) {
+        collectable = false;
+        return;
+    }
+
+    const BasePtrList collected = collectByTerm(pending);
+
+    summands.assign(cbegin(collected), cend(collected));
+    compacted = summands.size();
+}
+
+tsym::ProductBuilder& tsym::ProductBuilder::operator*=(const Var& factor)
+{
+    add(factor.get());
+
+    return *this;
+}
+
+tsym::ProductBuilder& tsym::ProductBuilder::operator/=(const Var& factor)
+{
+    add(Power::oneOver(factor.get()));
+
+    return *this;
+}
+
+void tsym::ProductBuilder::reserve(std::size_t n)
+{
+    factors.reserve(n);
+}
+
+std::size_t tsym::ProductBuilder::size() const
+{
+    return count;
+}
+
+tsym::Var tsym::ProductBuilder::get() const
+{
+    if (factors.empty())
+        return Var(Numeric::one());
+
+    return Var(Product::createLikeStepwise(BasePtrList(cbegin(factors), cend(factors))));
+}
+
+void tsym::ProductBuilder::add(Var::BasePtr factor)
+{
+    factors.push_back(std::move(factor));
+    ++count;
+
+    if (collectable && needsCompaction(factors.size(), compacted))
+        compact();
+}
+
+void tsym::ProductBuilder::compact()
+/* Same as for SumBuilder, with factors of equal bases: */
+{
+    const BasePtrList pending(cbegin(factors), cend(factors));
+
+    if (!canCollectByBase(pending)) {
+        collectable = false;
+        return;
+    }
+
+    const BasePtrList collected = collectByBase(pending);
+
+    factors.assign(cbegin(collected), cend(collected));
+    compacted = factors.size();
+}
@@ -1,28 +1,570 @@
 
 #include "cache.h"
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "base.h"
+#include "baseptrlistfct.h"
+#include "logging.h"
 
-namespace {
-    auto& clearFunctions()
+namespace tsym {
+    namespace {
+        auto& registeredCaches()
+        {
+            if constexpr (detail::threadLocalCaches) {
+                thread_local std::vector<detail::CacheBase*> caches;
+
+                return caches;
+            } else {
+                static std::vector<detail::CacheBase*> caches;
+
+                return caches;
+            }
+        }
+
+        std::size_t& globalCapacity()
+        {
+            static std::size_t capacity = detail::defaultCacheCapacity;
+
+            return capacity;
+        }
+
+        bool& globalWeakness()
+        {
+            static bool weak = false;
+
+            return weak;
+        }
+
+        std::mutex& registryMutex()
+        /* Guards the registry, the global capacity and weakness: */
+        {
+            static std::mutex mutex;
+
+            return mutex;
+        }
+
+        /* Incremented by requests that concern the caches of all threads: */
+        std::atomic<unsigned> clearGeneration = 0;
+        std::atomic<unsigned> capacityGeneration = 0;
+
+        /* The format version must be incremented whenever the encoding in cachecodec.cpp or the
+         * layout below changes: */
+        constexpr std::string_view fileMagic = "tsym-cache";
+        constexpr std::uint64_t fileFormatVersion = 1;
+        constexpr std::string_view libraryVersion = TSYM_VERSION_STRING;
+
+        using EncodedEntries = std::vector<std::pair<std::string, std::string>>;
+
+        struct PersistedEntry {
+            std::string_view key;
+            std::string_view value;
+        };
+
+        struct PersistedCaches {
+            /* The whole file content, all string views below point into it: */
+            std::string content;
+            std::unordered_map<std::string_view, std::unordered_multimap<std::uint64_t, PersistedEntry>> byName;
+        };
+
+        std::shared_ptr<const PersistedCaches>& persistedCaches()
+        {
+            static std::shared_ptr<const PersistedCaches> caches;
+
+            return caches;
+        }
+
+        std::mutex& persistedMutex()
+        {
+            static std::mutex mutex;
+
+            return mutex;
+        }
+
+        /* Set while persisted entries are loaded, such that in-memory misses don't touch the mutex
+         * above in the common case without any cache file: */
+        std::atomic<bool>& hasPersistedCaches()
+        {
+            static std::atomic<bool> flag = false;
+
+            return flag;
+        }
+
+        CacheScope*& innermostScope()
+        {
+            thread_local CacheScope* scope = nullptr;
+
+            return scope;
+        }
+
+        struct WeakStores {
+            /* Locked exclusively for (de-)registration only, purging happens concurrently: */
+            std::shared_mutex mutex;
+            std::vector<detail::WeakEntries*> stores;
+        };
+
+        WeakStores& weakStores()
+        {
+            static WeakStores weakStores;
+
+            return weakStores;
+        }
+
+        std::size_t nextCacheId()
+        {
+            static std::atomic<std::size_t> counter = 0;
+
+            return counter.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::shared_ptr<const PersistedCaches> persistedSnapshot()
+        {
+            if (!hasPersistedCaches().load(std::memory_order_acquire))
+                return nullptr;
+
+            const std::lock_guard<std::mutex> lock(persistedMutex());
+
+            return persistedCaches();
+        }
+
+        bool indexEntries(std::string_view& in, std::string_view cacheName, PersistedCaches& caches)
+        {
+            const auto count = detail::readVarint(in);
+            auto& entries = caches.byName[cacheName];
+
+            if (!count)
+                return false;
+
+            for (std::uint64_t i = 0; i < *count; ++i) {
+                const auto hash = detail::readVarint(in);
+                const auto key = detail::readBytes(in);
+                const auto value = detail::readBytes(in);
+
+                if (!hash || !key || !value)
+                    return false;
+
+                entries.emplace(*hash, PersistedEntry{*key, *value});
+            }
+
+            return true;
+        }
+
+        bool index(PersistedCaches& caches)
+        {
+            std::string_view in(caches.content);
+
+            if (in.substr(0, fileMagic.size()) != fileMagic)
+                return false;
+
+            in.remove_prefix(fileMagic.size());
+
+            const auto formatVersion = detail::readVarint(in);
+            const auto version = detail::readBytes(in);
+            const auto sectionCount = detail::readVarint(in);
+
+            if (formatVersion != fileFormatVersion || version != libraryVersion || !sectionCount)
+                return false;
+
+            for (std::uint64_t i = 0; i < *sectionCount; ++i)
+                if (const auto name = detail::readBytes(in); !name || !indexEntries(in, *name, caches))
+                    return false;
+
+            return in.empty();
+        }
+
+        void appendUnknownPersistedEntries(std::map<std::string, EncodedEntries, std::less<>>& sections)
+        /* Entries loaded from a file that haven't been looked up yet must survive saving again: */
+        {
+            const auto persisted = persistedSnapshot();
+
+            if (!persisted)
+                return;
+
+            for (const auto& [name, entries] : persisted->byName) {
+                auto& section = sections[std::string(name)];
+                std::unordered_set<std::string_view> known;
+
+                for (const auto& entry : section)
+                    known.insert(entry.first);
+
+                for (const auto& [hash, entry] : entries)
+                    if (known.count(entry.key) == 0)
+                        section.emplace_back(std::string(entry.key), std::string(entry.value));
+            }
+        }
+    }
+}
+
+tsym::detail::CacheBase::CacheBase(std::string_view name)
+    : cacheName(name)
+    , instanceId(nextCacheId())
+{}
+
+void tsym::detail::CacheBase::registerInstance()
+{
+    const std::lock_guard<std::mutex> lock(registryMutex());
+
+    seenClearGeneration = clearGeneration.load(std::memory_order_relaxed);
+    seenCapacityGeneration = capacityGeneration.load(std::memory_order_relaxed);
+
+    setCapacity(globalCapacity());
+    setWeak(globalWeakness());
+    registeredCaches().push_back(this);
+}
+
+void tsym::detail::CacheBase::deregisterInstance()
+{
     {
-        static std::map<const short*, std::function<void()>> clearFunctions;
+        const std::lock_guard<std::mutex> lock(registryMutex());
+        auto& caches = registeredCaches();
 
-        return clearFunctions;
+        caches.erase(std::remove(begin(caches), end(caches), this), end(caches));
     }
+
+    /* Otherwise, contexts accumulate layers of destroyed caches, e.g. thread-local ones: */
+    removeContextLayers(instanceId);
 }
 
-void tsym::detail::registerCacheClearer(const short* address, std::function<void()>&& fct)
+void tsym::detail::CacheBase::synchronizeWithOtherThreads()
 {
-    clearFunctions()[address] = std::move(fct);
+    if (const unsigned current = clearGeneration.load(std::memory_order_relaxed); current != seenClearGeneration) {
+        seenClearGeneration = current;
+        clear();
+    }
+
+    if (const unsigned current = capacityGeneration.load(std::memory_order_relaxed);
+        current != seenCapacityGeneration) {
+        const std::lock_guard<std::mutex> lock(registryMutex());
+
+        seenCapacityGeneration = current;
+        setCapacity(globalCapacity());
+    }
 }
 
-void tsym::detail::deregisterCacheClearer(const short* address)
+std::size_t tsym::detail::CacheBase::id() const
 {
-    clearFunctions().erase(address);
+    return instanceId;
+}
+
+bool tsym::detail::hasPersistedEntries(std::string_view cacheName)
+{
+    const auto persisted = persistedSnapshot();
+
+    return persisted && persisted->byName.count(cacheName) != 0;
+}
+
+std::optional<std::string> tsym::detail::findPersisted(std::string_view cacheName, std::string_view encodedKey)
+{
+    const auto persisted = persistedSnapshot();
+
+    if (!persisted)
+        return std::nullopt;
+    else if (const auto section = persisted->byName.find(cacheName); section != cend(persisted->byName))
+        for (auto [it, last] = section->second.equal_range(stableHash(encodedKey)); it != last; ++it)
+            if (it->second.key == encodedKey)
+                return std::string(it->second.value);
+
+    return std::nullopt;
+}
+
+std::string_view tsym::detail::CacheBase::name() const
+{
+    return cacheName;
 }
 
 void tsym::clearRegisteredCaches()
 {
-    for ([[maybe_unused]] auto& [unused, clearFctEntry] : clearFunctions())
-        clearFctEntry();
+    const std::lock_guard<std::mutex> lock(registryMutex());
+
+    for (auto* cache : registeredCaches())
+        cache->clear();
+}
+
+void tsym::clearRegisteredCachesOfAllThreads()
+{
+    clearGeneration.fetch_add(1, std::memory_order_relaxed);
+
+    clearRegisteredCaches();
+}
+
+std::vector<tsym::CacheStats> tsym::registeredCacheStats()
+{
+    const std::lock_guard<std::mutex> lock(registryMutex());
+    std::vector<CacheStats> result;
+
+    for (const auto* cache : registeredCaches())
+        result.push_back(cache->stats());
+
+    return result;
+}
+
+void tsym::setRegisteredCacheCapacity(std::size_t maxEntries)
+{
+    const std::lock_guard<std::mutex> lock(registryMutex());
+
+    globalCapacity() = maxEntries;
+    capacityGeneration.fetch_add(1, std::memory_order_relaxed);
+
+    for (auto* cache : registeredCaches())
+        cache->setCapacity(maxEntries);
+}
+
+bool tsym::setRegisteredCacheCapacity(std::string_view name, std::size_t maxEntries)
+{
+    const std::lock_guard<std::mutex> lock(registryMutex());
+    bool found = false;
+
+    for (auto* cache : registeredCaches())
+        if (cache->name() == name) {
+            cache->setCapacity(maxEntries);
+            found = true;
+        }
+
+    return found;
+}
+
+bool tsym::setWeakRegisteredCaches(bool weak)
+{
+    if constexpr (detail::threadLocalCaches)
+        return false;
+
+    const std::lock_guard<std::mutex> lock(registryMutex());
+
+    globalWeakness() = weak;
+
+    for (auto* cache : registeredCaches())
+        cache->setWeak(weak);
+
+    return true;
+}
+
+void tsym::detail::registerWeakEntries(WeakEntries* store)
+{
+    auto& [mutex, stores] = weakStores();
+    const std::lock_guard<std::shared_mutex> lock(mutex);
+
+    stores.push_back(store);
+}
+
+void tsym::detail::deregisterWeakEntries(WeakEntries* store)
+{
+    auto& [mutex, stores] = weakStores();
+    const std::lock_guard<std::shared_mutex> lock(mutex);
+
+    stores.erase(std::remove(begin(stores), end(stores), store), end(stores));
+}
+
+void tsym::detail::purgeWeakCacheEntries(const Base& node)
+{
+    auto& [mutex, stores] = weakStores();
+    const std::shared_lock<std::shared_mutex> lock(mutex);
+
+    for (auto* store : stores)
+        store->purge(node);
+}
+
+bool tsym::saveRegisteredCaches(const std::string& path)
+{
+    std::map<std::string, EncodedEntries, std::less<>> sections;
+    std::string content(fileMagic);
+
+    {
+        const std::lock_guard<std::mutex> lock(registryMutex());
+
+        for (const auto* cache : registeredCaches())
+            cache->encodeEntries(sections[std::string(cache->name())]);
+    }
+
+    appendUnknownPersistedEntries(sections);
+
+    for (auto it = begin(sections); it != end(sections);)
+        it = it->second.empty() ? sections.erase(it) : std::next(it);
+
+    detail::writeVarint(fileFormatVersion, content);
+    detail::writeBytes(libraryVersion, content);
+    detail::writeVarint(sections.size(), content);
+
+    for (const auto& [name, entries] : sections) {
+        detail::writeBytes(name, content);
+        detail::writeVarint(entries.size(), content);
+
+        for (const auto& [key, value] : entries) {
+            detail::writeVarint(stableHash(key), content);
+            detail::writeBytes(key, content);
+            detail::writeBytes(value, content);
+        }
+    }
+
+    /* Written to a temporary file first and moved over the target afterwards, such that a crash
+     * or a concurrent load never sees a truncated file: */
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    std::error_code error;
+
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    file.close();
+
+    if (!file) {
+        TSYM_WARNING("Can't write cache file '%s'", tmpPath);
+        std::filesystem::remove(tmpPath, error);
+        return false;
+    }
+
+    std::filesystem::rename(tmpPath, path, error);
+
+    if (error) {
+        TSYM_WARNING("Can't move cache file '%s' to '%s': %s", tmpPath, path, error.message());
+        std::filesystem::remove(tmpPath, error);
+        return false;
+    }
+
+    return true;
+}
+
+bool tsym::loadRegisteredCaches(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    auto caches = std::make_shared<PersistedCaches>();
+
+    if (!file) {
+        TSYM_WARNING("Can't open cache file '%s'", path);
+        return false;
+    }
+
+    caches->content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (!index(*caches)) {
+        TSYM_WARNING("Cache file '%s' is malformed or stems from another version, ignore it", path);
+        return false;
+    }
+
+    const std::lock_guard<std::mutex> lock(persistedMutex());
+
+    persistedCaches() = std::move(caches);
+    hasPersistedCaches().store(true, std::memory_order_release);
+
+    return true;
+}
+
+void tsym::discardPersistedCacheEntries()
+{
+    const std::lock_guard<std::mutex> lock(persistedMutex());
+
+    persistedCaches().reset();
+    hasPersistedCaches().store(false, std::memory_order_release);
+}
+
+tsym::CacheScope::CacheScope()
+    : parent(std::exchange(innermostScope(), this))
+{}
+
+tsym::CacheScope::~CacheScope()
+{
+    innermostScope() = parent;
+}
+
+tsym::CacheScope* tsym::CacheScope::innermost()
+{
+    return innermostScope();
+}
+
+const tsym::CacheScope* tsym::CacheScope::outer() const
+{
+    return parent;
+}
+
+tsym::detail::CacheLayer* tsym::CacheScope::layer(std::size_t cacheId) const
+{
+    const auto lookup = layers.find(cacheId);
+
+    return lookup == cend(layers) ? nullptr : lookup->second.get();
+}
+
+tsym::detail::CacheLayer& tsym::CacheScope::addLayer(std::size_t cacheId, std::unique_ptr<detail::CacheLayer> layer)
+{
+    return *layers.emplace(cacheId, std::move(layer)).first->second;
+}
+
+tsym::ListLookup::ListLookup(BasePtrListView items)
+    : items(items)
+    , isPair(false)
+    , hashValue(combinedHash())
+{}
+
+tsym::ListLookup::ListLookup(const BasePtr& first, const BasePtr& second)
+    : pair{&first, &second}
+    , isPair(true)
+    , hashValue(combinedHash())
+{}
+
+std::size_t tsym::ListLookup::hash() const
+{
+    return hashValue;
+}
+
+bool tsym::ListLookup::matches(const BasePtrList& list) const
+{
+    if (list.size() != size())
+        return false;
+
+    for (std::size_t i = 0; i < list.size(); ++i)
+        if (!list[i]->isEqual(*(*this)[i]))
+            return false;
+
+    return true;
+}
+
+tsym::ListLookup::operator BasePtrList() const
+{
+    return isPair ? BasePtrList{*pair.front(), *pair.back()} : BasePtrList(items.begin(), items.end());
+}
+
+std::size_t tsym::ListLookup::size() const
+{
+    return isPair ? pair.size() : items.size();
+}
+
+const tsym::BasePtr& tsym::ListLookup::operator[](std::size_t n) const
+{
+    return isPair ? *pair[n] : items[static_cast<std::ptrdiff_t>(n)];
+}
+
+std::size_t tsym::ListLookup::combinedHash() const
+/* Same as boost::hash_range, which hash_value(const BasePtrList&) uses: */
+{
+    std::size_t seed = 0;
+
+    for (std::size_t i = 0; i < size(); ++i)
+        boost::hash_combine(seed, (*this)[i]);
+
+    return seed;
+}
+
+std::size_t tsym::ListHash::operator()(const BasePtrList& list) const
+{
+    return hash_value(list);
+}
+
+std::size_t tsym::ListHash::operator()(const ListLookup& lookup) const
+{
+    return lookup.hash();
+}
+
+bool tsym::ListEqualTo::operator()(const BasePtrList& lhs, const BasePtrList& rhs) const
+{
+    return areEqual(lhs, rhs);
+}
+
+bool tsym::ListEqualTo::operator()(const BasePtrList& list, const ListLookup& lookup) const
+{
+    return lookup.matches(list);
 }
@@ -1,40 +1,839 @@
 #ifndef TSYM_CACHE_H
 #define TSYM_CACHE_H
 
-#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+#include "cachecodec.h"
+#include "flatcachetable.h"
+
+#ifdef TSYM_THREAD_LOCAL_CACHES
+/* Every thread gets its own instance of every cache, which is then used without any locking: */
+#define TSYM_CACHE_STORAGE thread_local
+#else
+#define TSYM_CACHE_STORAGE static
+#endif
 
 namespace tsym {
+    class Context;
+
+    struct CacheStats {
+        std::string_view name;
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        /* Misses that were resolved by an entry loaded from a file: */
+        std::size_t persistedHits = 0;
+        std::size_t insertions = 0;
+        std::size_t evictions = 0;
+        std::size_t entries = 0;
+        std::size_t capacity = 0;
+        /* Size of the container itself, i.e., entries and index structures. Memory owned by keys
+         * or values, e.g. expression nodes referenced by a BasePtr, isn't taken into account: */
+        std::size_t approxBytes = 0;
+    };
+
+    /* With thread-local caches, the functions below only act on the caches of the calling thread,
+     * except for the global capacity setter and clearRegisteredCachesOfAllThreads. The latter two
+     * take effect for other threads upon their next cache access. Without thread-local caches,
+     * the two clear functions are identical. */
     void clearRegisteredCaches();
+    void clearRegisteredCachesOfAllThreads();
+    /* One element per cache in the order of their construction. Counters accumulate from the
+     * creation of a cache on and are not affected by clearing it: */
+    std::vector<CacheStats> registeredCacheStats();
+
+    /* Limits the number of entries of all registered caches, including those that are created
+     * later on. When a cache is full, an entry that wasn't used recently is evicted. A capacity of zero
+     * disables caching: */
+    void setRegisteredCacheCapacity(std::size_t maxEntries);
+    /* Same as above, but only for the cache with the given name. Returns false if there is no
+     * such cache, e.g. because it hasn't been used yet: */
+    bool setRegisteredCacheCapacity(std::string_view name, std::size_t maxEntries);
+
+    /* With weak entries, the caches don't keep expressions alive. An entry is purged right before
+     * one of the expression nodes of its key or value is destroyed, i.e., as soon as the
+     * expression isn't referenced anywhere else, and memory follows the working set instead of
+     * the history of computations. Lookups are slightly more expensive. The setting applies to
+     * caches that are created later on, too, but not to the entries of a Context or CacheScope.
+     * Switching clears the caches. Weak entries aren't available with thread-local caches, where
+     * the function returns false and does nothing: */
+    bool setWeakRegisteredCaches(bool weak);
+
+    /* Writes the entries of all caches whose key and value types can be encoded (see
+     * cachecodec.h) to the given file. Entries loaded from a file earlier on are included, too.
+     * The file is replaced only after the complete content was written to "<path>.tmp". Returns
+     * false if the file couldn't be written: */
+    bool saveRegisteredCaches(const std::string& path);
+    /* Makes the entries of the given file available to the caches. The file is indexed by the
+     * stable hash of the encoded keys right away, but values are only decoded upon a miss of their
+     * key, and then moved into the in-memory cache. Returns false and keeps the previously loaded
+     * entries if the file can't be read, is malformed or was written by a different version: */
+    bool loadRegisteredCaches(const std::string& path);
+    void discardPersistedCacheEntries();
+
+    class ListLookup {
+        /* Transparent lookup key for caches with BasePtrList keys, see ListHash and ListEqualTo.
+         * It refers to existing handles instead of copying them into a list, and its hash is
+         * computed once upon construction and equals the one of the corresponding list. The
+         * referenced handles must outlive the instance. */
+      public:
+        explicit ListLookup(BasePtrListView items);
+        ListLookup(const BasePtr& first, const BasePtr& second);
+
+        std::size_t hash() const;
+        bool matches(const BasePtrList& list) const;
+        /* For the insertion after a miss: */
+        explicit operator BasePtrList() const;
+
+      private:
+        std::size_t size() const;
+        const BasePtr& operator[](std::size_t n) const;
+        std::size_t combinedHash() const;
+
+        const BasePtrListView items;
+        const std::array<const BasePtr*, 2> pair{};
+        const bool isPair;
+        const std::size_t hashValue;
+    };
+
+    struct ListHash {
+        std::size_t operator()(const BasePtrList& list) const;
+        std::size_t operator()(const ListLookup& lookup) const;
+    };
+
+    struct ListEqualTo {
+        bool operator()(const BasePtrList& lhs, const BasePtrList& rhs) const;
+        bool operator()(const BasePtrList& list, const ListLookup& lookup) const;
+    };
 
     namespace detail {
-        void registerCacheClearer(const short* address, std::function<void()>&& fct);
-        void deregisterCacheClearer(const short* address);
+#ifdef TSYM_THREAD_LOCAL_CACHES
+        inline constexpr bool threadLocalCaches = true;
+#else
+        inline constexpr bool threadLocalCaches = false;
+#endif
+
+        inline constexpr std::size_t defaultCacheCapacity = 1u << 16u;
+
+        struct NullMutex {
+            void lock() {}
+            void unlock() {}
+        };
+
+        using CacheMutex = std::conditional_t<threadLocalCaches, NullMutex, std::mutex>;
+
+        class CacheBase {
+            /* Common interface of all caches, instances register themselves upon construction to
+             * be accessible by the free functions above. Subclasses must call registerInstance()
+             * when fully constructed and deregisterInstance() before being destroyed, as the
+             * registry might call into them from other threads. */
+          public:
+            CacheBase(const CacheBase&) = delete;
+            CacheBase& operator=(const CacheBase&) = delete;
+            CacheBase(CacheBase&&) = delete;
+            CacheBase& operator=(CacheBase&&) = delete;
+
+            std::string_view name() const;
+            /* Unique for every instance, also for instances that reuse the memory of another: */
+            std::size_t id() const;
+            virtual void clear() = 0;
+            virtual void setCapacity(std::size_t maxEntries) = 0;
+            virtual void setWeak(bool weak) = 0;
+            virtual CacheStats stats() const = 0;
+            /* Appends encoded key-value pairs, does nothing for types without a CacheCodec: */
+            virtual void encodeEntries(std::vector<std::pair<std::string, std::string>>& entries) const = 0;
+
+          protected:
+            explicit CacheBase(std::string_view name);
+            ~CacheBase() = default;
+
+            /* Also applies the current global capacity and weakness: */
+            void registerInstance();
+            void deregisterInstance();
+
+            /* To be called before every access, picks up requests issued by other threads: */
+            void synchronize()
+            {
+                if constexpr (threadLocalCaches)
+                    synchronizeWithOtherThreads();
+            }
+
+          private:
+            void synchronizeWithOtherThreads();
+
+            const std::string_view cacheName;
+            const std::size_t instanceId;
+            unsigned seenClearGeneration = 0;
+            unsigned seenCapacityGeneration = 0;
+        };
+
+        bool hasPersistedEntries(std::string_view cacheName);
+        std::optional<std::string> findPersisted(std::string_view cacheName, std::string_view encodedKey);
+
+        struct CacheLayer {
+            /* Entries of one cache that are private to a CacheScope or a Context. */
+            virtual ~CacheLayer() = default;
+            virtual void clear() = 0;
+            /* Layers of a CacheScope are unbounded and ignore this: */
+            virtual void setCapacity(std::size_t /* maxEntries */) {}
+        };
+
+        /* Lookup of the layers of the Context selected by the calling thread, see context.h: */
+        Context* selectedContext();
+        CacheLayer* findContextLayer(const Context& context, std::size_t cacheId);
+        /* Applies the capacity of the context, returns the existing layer if another thread was faster: */
+        CacheLayer& addContextLayer(Context& context, std::size_t cacheId, std::unique_ptr<CacheLayer> layer);
+        /* Drops the layers of a cache instance that is about to be destroyed from all contexts: */
+        void removeContextLayers(std::size_t cacheId);
+
+        template <class T> struct ExprRefs {
+            /* Visits every expression handle held by a key or value, as only these can be weak.
+             * Obj is T or const T: */
+            template <class Obj, class Fct> static void forEach(Obj& /* obj */, Fct&& /* fct */) {}
+        };
+
+        template <> struct ExprRefs<BasePtr> {
+            template <class Obj, class Fct> static void forEach(Obj& ptr, Fct&& fct)
+            {
+                fct(ptr);
+            }
+        };
+
+        template <> struct ExprRefs<BasePtrList> {
+            template <class Obj, class Fct> static void forEach(Obj& list, Fct&& fct)
+            {
+                for (auto& item : list)
+                    fct(item);
+            }
+        };
+
+        template <class S, class T> struct ExprRefs<std::pair<S, T>> {
+            template <class Obj, class Fct> static void forEach(Obj& pair, Fct&& fct)
+            {
+                ExprRefs<S>::forEach(pair.first, fct);
+                ExprRefs<T>::forEach(pair.second, fct);
+            }
+        };
+
+        class WeakEntries {
+            /* Stores with weak entries register themselves to be notified before a node that one
+             * of their entries refers to is destroyed. */
+          public:
+            virtual void purge(const Base& node) = 0;
+
+          protected:
+            ~WeakEntries() = default;
+        };
+
+        void registerWeakEntries(WeakEntries* store);
+        void deregisterWeakEntries(WeakEntries* store);
+        /* Called upon destruction of a node marked by markWeaklyReferenced: */
+        void purgeWeakCacheEntries(const Base& node);
+
+        template <class Key, class Value, class Hash, class EqualTo, class Mutex>
+        class ShardedStore : private WeakEntries {
+            /* Bounded map that evicts entries which weren't used recently. The entries are
+             * distributed over a fixed number of shards by their hash, and each shard is guarded
+             * by its own mutex, such that threads working on different keys rarely contend. Every
+             * shard is a FlatCacheTable, the hash of a key is computed once per operation and
+             * used for both the shard selection and the table. The capacity is split across
+             * shards, with the remainder of the division going to the first ones.
+             *
+             * Weak entries don't own the expression nodes in their key and value. Instead, the
+             * nodes are marked, and the store keeps an index from nodes to the entries referring
+             * to them, such that all of these entries are erased before the node is destroyed.
+             * A node whose count already dropped to zero can't be handed out by a lookup anymore.
+             * Shard locks are always acquired before the index lock, and no node is ever released
+             * while a lock of a shard with weak entries is held. */
+          public:
+            /* Without locking, other threads can't purge weak entries: */
+            static constexpr bool weakSupported = !std::is_same_v<Mutex, NullMutex>;
+
+            explicit ShardedStore(std::size_t shardCount)
+                : shards(shardCount == 0 ? 1 : shardCount)
+            {}
+
+            ShardedStore(const ShardedStore&) = delete;
+            ShardedStore& operator=(const ShardedStore&) = delete;
+            ShardedStore(ShardedStore&&) = delete;
+            ShardedStore& operator=(ShardedStore&&) = delete;
+            ~ShardedStore()
+            {
+                setWeak(false);
+            }
+
+            /* The lookup can be of any type that Hash and EqualTo accept besides Key, its hash is
+             * computed by the caller: */
+            template <class Lookup> std::optional<Value> find(const Lookup& key, std::size_t hash)
+            {
+                /* Nodes that failed to be pinned are released after the shard lock: */
+                std::vector<BasePtr> unpinned;
+                Shard& shard = shardOf(hash);
+                const std::lock_guard<Mutex> lock(shard.mutex);
+                const Entry* entry = shard.entries.find(key, hash);
+
+                if (entry == nullptr || (shard.weak && !pin(entry->value, unpinned))) {
+                    ++shard.counter.misses;
+                    return std::nullopt;
+                }
+
+                ++shard.counter.hits;
+
+                std::optional<Value> result(entry->value);
+
+                if (shard.weak)
+                    ExprRefs<Value>::forEach(entry->value, [](const BasePtr& node) { releaseNonLast(node.get()); });
+
+                return result;
+            }
+
+            void store(Key key, const Value& value, bool fromPersisted = false)
+            /* The key parameter outlives the shard lock. An unused key might hold the last reference
+             * to a node of a weak entry, which must only be destroyed without the lock. A weak entry
+             * gets a copy of the key, such that the parameter still owns its nodes in weaken(): */
+            {
+                const std::size_t hash = Hash{}(key);
+                Shard& shard = shardOf(hash);
+                const std::lock_guard<Mutex> lock(shard.mutex);
+
+                if (fromPersisted)
+                    ++shard.counter.persistedHits;
+
+                if (shard.capacity == 0)
+                    return;
+
+                if (const auto [index, inserted] = shard.weak ? shard.entries.tryEmplace(key, hash, value)
+                                                              : shard.entries.tryEmplace(std::move(key), hash, value);
+                    inserted) {
+                    ++shard.counter.insertions;
+
+                    if (shard.weak)
+                        weaken(shard, index);
+
+                    shrink(shard, index);
+                }
+            }
+
+            void clear()
+            {
+                for (Shard& shard : shards) {
+                    const std::lock_guard<Mutex> lock(shard.mutex);
+
+                    clear(shard);
+                }
+            }
+
+            void setCapacity(std::size_t maxEntries)
+            {
+                const std::size_t perShard = maxEntries / shards.size();
+                const std::size_t remainder = maxEntries % shards.size();
+
+                capacity = maxEntries;
+
+                for (std::size_t i = 0; i < shards.size(); ++i) {
+                    Shard& shard = shards[i];
+                    const std::lock_guard<Mutex> lock(shard.mutex);
+
+                    /* The total is exactly the given capacity, even if it's smaller than the number
+                     * of shards: */
+                    shard.capacity = i < remainder ? perShard + 1 : perShard;
+                    shrink(shard, Table::noIndex);
+                }
+            }
+
+            std::size_t getCapacity() const
+            {
+                return capacity;
+            }
+
+            /* Clears all entries if the mode changes: */
+            void setWeak(bool weak)
+            {
+                if constexpr (weakSupported) {
+                    if (weak == isWeak)
+                        return;
+
+                    isWeak = weak;
+
+                    /* Nodes must be able to purge entries as long as any weak one exists, so the store
+                     * is registered before the first and deregistered after the last of them: */
+                    if (weak)
+                        registerWeakEntries(this);
+
+                    for (Shard& shard : shards) {
+                        const std::lock_guard<Mutex> lock(shard.mutex);
+
+                        clear(shard);
+                        shard.weak = weak;
+                    }
+
+                    if (!weak)
+                        deregisterWeakEntries(this);
+                }
+            }
+
+            /* Adds counters, entries and footprint to the given stats: */
+            void accumulate(CacheStats& stats) const
+            {
+                stats.capacity += capacity;
+                stats.approxBytes += sizeof(*this) + shards.size() * sizeof(Shard);
+
+                for (const Shard& shard : shards) {
+                    const std::lock_guard<Mutex> lock(shard.mutex);
+
+                    stats.hits += shard.counter.hits;
+                    stats.misses += shard.counter.misses;
+                    stats.persistedHits += shard.counter.persistedHits;
+                    stats.insertions += shard.counter.insertions;
+                    stats.evictions += shard.counter.evictions;
+                    stats.entries += shard.entries.size();
+                    stats.approxBytes += shard.entries.footprint();
+                }
+
+                /* Estimate per node of the index: the value, a pointer to the next node and the
+                 * cached hash, plus one bucket pointer: */
+                static constexpr std::size_t nodeSize = sizeof(typename Referrers::value_type) + 3 * sizeof(void*);
+                const std::lock_guard<std::mutex> lock(referrersMutex);
+
+                stats.approxBytes += referrers.size() * nodeSize;
+            }
+
+            template <class Fct> void forEach(Fct&& fct) const
+            {
+                for (const Shard& shard : shards) {
+                    const std::lock_guard<Mutex> lock(shard.mutex);
+
+                    shard.entries.forEach([&fct](Index, const Entry& entry) { fct(entry.key, entry.value); });
+                }
+            }
+
+          private:
+            using Table = FlatCacheTable<Key, Value, EqualTo>;
+            using Entry = typename Table::Entry;
+            using Index = typename Table::Index;
+
+            struct alignas(64) Shard {
+                /* The alignment keeps the mutexes of adjacent shards in different cache lines. */
+                mutable Mutex mutex;
+                Table entries;
+                std::size_t capacity = 0;
+                bool weak = false;
+                CacheStats counter;
+            };
+
+            using Referrers = std::unordered_multimap<const Base*, std::pair<Shard*, Index>>;
+
+            template <class Fct> static void forEachNode(const Entry& entry, Fct&& fct)
+            {
+                ExprRefs<Key>::forEach(entry.key, fct);
+                ExprRefs<Value>::forEach(entry.value, fct);
+            }
+
+            void shrink(Shard& shard, Index spared)
+            {
+                while (shard.entries.size() > shard.capacity) {
+                    erase(shard, shard.entries.victim(spared));
+                    ++shard.counter.evictions;
+                }
+            }
+
+            void clear(Shard& shard)
+            {
+                if (shard.weak)
+                    shard.entries.forEach([this, &shard](Index index, const Entry&) { disown(shard, index); });
+
+                shard.entries.clear();
+            }
+
+            void erase(Shard& shard, Index index)
+            {
+                if (shard.weak)
+                    disown(shard, index);
+
+                shard.entries.erase(index);
+            }
+
+            void disown(Shard& shard, Index index)
+            /* Prepares the destruction of a weak entry, which doesn't own its nodes: */
+            {
+                Entry& entry = shard.entries.entry(index);
+
+                unindex(shard, index);
+                ExprRefs<Key>::forEach(entry.key, [](BasePtr& node) { node.detach(); });
+                ExprRefs<Value>::forEach(entry.value, [](BasePtr& node) { node.detach(); });
+            }
+
+            void weaken(Shard& shard, Index index)
+            /* store() still owns a copy of the key and the caller owns the value, so none of the
+             * nodes can drop to zero: */
+            {
+                const std::lock_guard<std::mutex> lock(referrersMutex);
+
+                forEachNode(shard.entries.entry(index), [this, &shard, index](const BasePtr& node) {
+                    markWeaklyReferenced(node.get());
+                    releaseNonLast(node.get());
+                    referrers.emplace(node.get(), std::make_pair(&shard, index));
+                });
+            }
+
+            void unindex(Shard& shard, Index index)
+            {
+                const std::lock_guard<std::mutex> lock(referrersMutex);
+
+                forEachNode(shard.entries.entry(index), [this, &shard, index](const BasePtr& node) {
+                    auto [first, last] = referrers.equal_range(node.get());
+
+                    while (first != last)
+                        if (first->second == std::make_pair(&shard, index))
+                            first = referrers.erase(first);
+                        else
+                            ++first;
+                });
+            }
+
+            static bool pin(const Value& value, std::vector<BasePtr>& unpinned)
+            /* Acquires a reference to every node of the value, or to none of them if one is about
+             * to be destroyed. In the latter case, the already acquired ones are handed over to
+             * the given vector: */
+            {
+                std::size_t pinned = 0;
+                bool alive = true;
+
+                ExprRefs<Value>::forEach(value, [&pinned, &alive](const BasePtr& node) {
+                    if (alive && tryAddRef(node.get()))
+                        ++pinned;
+                    else
+                        alive = false;
+                });
+
+                if (!alive)
+                    ExprRefs<Value>::forEach(value, [&pinned, &unpinned](const BasePtr& node) {
+                        if (pinned > 0) {
+                            unpinned.emplace_back(node.get(), false);
+                            --pinned;
+                        }
+                    });
+
+                return alive;
+            }
+
+            void purge(const Base& node) override
+            {
+                std::vector<Shard*> affected;
+
+                {
+                    const std::lock_guard<std::mutex> lock(referrersMutex);
+                    const auto [first, last] = referrers.equal_range(&node);
+
+                    for (auto it = first; it != last; ++it)
+                        if (std::find(affected.cbegin(), affected.cend(), it->second.first) == affected.cend())
+                            affected.push_back(it->second.first);
+                }
+
+                for (Shard* shard : affected) {
+                    const std::lock_guard<Mutex> lock(shard->mutex);
+                    std::vector<Index> indices;
+
+                    {
+                        const std::lock_guard<std::mutex> referrersLock(referrersMutex);
+                        const auto [first, last] = referrers.equal_range(&node);
+
+                        for (auto it = first; it != last; ++it)
+                            if (it->second.first == shard
+                              && std::find(indices.cbegin(), indices.cend(), it->second.second) == indices.cend())
+                                indices.push_back(it->second.second);
+                    }
+
+                    for (const Index index : indices)
+                        erase(*shard, index);
+                }
+            }
+
+            Shard& shardOf(std::size_t hash)
+            {
+                return shards[(hash ^ (hash >> 16u)) % shards.size()];
+            }
+
+            std::vector<Shard> shards;
+            std::atomic<std::size_t> capacity = 0;
+            /* Only modified by setWeak, which isn't called concurrently on the same store: */
+            bool isWeak = false;
+            mutable std::mutex referrersMutex;
+            Referrers referrers;
+        };
     }
 
+    class CacheScope {
+        /* While an instance exists, the values inserted into registered caches by the constructing
+         * thread end up in a private layer owned by the scope, and lookups consult this layer
+         * before the shared caches. Destroying the scope drops all of its entries at once, without
+         * touching the shared caches, which keep their warm entries. Scopes can be nested, and
+         * inner scopes see the entries of outer ones. They must be destroyed in reverse order of
+         * their construction on the same thread. Entries of a scope aren't limited by a capacity
+         * (except that zero disables caching) and don't show up in the cache statistics. */
+      public:
+        CacheScope();
+        CacheScope(const CacheScope&) = delete;
+        CacheScope& operator=(const CacheScope&) = delete;
+        CacheScope(CacheScope&&) = delete;
+        CacheScope& operator=(CacheScope&&) = delete;
+        ~CacheScope();
+
+        /* The most recently constructed scope of the calling thread or nullptr: */
+        static CacheScope* innermost();
+        const CacheScope* outer() const;
+
+        detail::CacheLayer* layer(std::size_t cacheId) const;
+        detail::CacheLayer& addLayer(std::size_t cacheId, std::unique_ptr<detail::CacheLayer> layer);
+
+      private:
+        CacheScope* const parent;
+        std::unordered_map<std::size_t, std::unique_ptr<detail::CacheLayer>> layers;
+    };
+
     template <class Key, class Value, class Hash = std::hash<Key>, class EqualTo = std::equal_to<Key>>
-    struct RegisteredCache {
-        /* This wrapper stores exposes the cache container publicly and automatically
-         * registers and unregisteres a member function reference to clear the cache. */
-        RegisteredCache()
+    class RegisteredCache : public detail::CacheBase {
+        /* Bounded cache that evicts entries which weren't used recently, see ShardedStore above.
+         * All member functions can be called concurrently, unless the library is built with
+         * thread-local caches. Then, there is a single shard without locking. Lookups and
+         * insertions go to a separate store while a Context is selected by the calling thread. The
+         * registry functions and stats only cover the shared store, Context offers its own
+         * functions for its stores. */
+      public:
+        static constexpr std::size_t defaultShardCount = detail::threadLocalCaches ? 1 : 32;
+
+        explicit RegisteredCache(std::string_view name, std::size_t shardCount = defaultShardCount)
+            : CacheBase(name)
+            , shared(shardCount)
         {
-            detail::registerCacheClearer(&address, [this]() { decltype(map){}.swap(map); });
+            registerInstance();
         }
 
         RegisteredCache(const RegisteredCache&) = delete;
         RegisteredCache& operator=(const RegisteredCache&) = delete;
         RegisteredCache(RegisteredCache&&) = delete;
         RegisteredCache& operator=(RegisteredCache&&) = delete;
-
         ~RegisteredCache()
         {
-            detail::deregisterCacheClearer(&address);
+            deregisterInstance();
+        }
+
+        /* Returns a copy of the cached value, as a reference could be invalidated by another
+         * thread right away. Besides Key, the lookup can be of any type that Hash and EqualTo
+         * accept as second argument, e.g. a ListLookup for BasePtrList keys, such that a hit
+         * doesn't need to construct a key. Such a type must be explicitly convertible to Key: */
+        template <class Lookup> std::optional<Value> find(const Lookup& key)
+        {
+            const std::size_t hash = Hash{}(key);
+
+            synchronize();
+
+            for (const CacheScope* scope = CacheScope::innermost(); scope != nullptr; scope = scope->outer())
+                if (auto* scoped = static_cast<ScopeLayer*>(scope->layer(id())))
+                    if (const auto* entry = scoped->entries.find(key, hash))
+                        return entry->value;
+
+            auto store = activeStore();
+
+            if (auto value = store.find(key, hash))
+                return value;
+            else if constexpr (persistable)
+                return findPersisted(key, store);
+            else
+                return std::nullopt;
+        }
+
+        /* Stores the given key-value pair and returns the value for convenience. Pass a temporary
+         * key to have it moved into the cache. The value is computed without holding the lock, so
+         * two threads might both miss and insert the same key, in which case the first insertion
+         * wins: */
+        Value insert(Key key, Value value)
+        {
+            synchronize();
+
+            if (CacheScope* scope = CacheScope::innermost()) {
+                const std::size_t hash = Hash{}(key);
+
+                if (activeStore().getCapacity() != 0)
+                    scopeLayerOf(*scope).entries.tryEmplace(std::move(key), hash, value);
+            } else
+                activeStore().store(std::move(key), value);
+
+            return value;
+        }
+
+        void clear() override
+        {
+            shared.clear();
+        }
+
+        void setCapacity(std::size_t maxEntries) override
+        {
+            shared.setCapacity(maxEntries);
+        }
+
+        void setWeak(bool weak) override
+        {
+            shared.setWeak(weak);
+        }
+
+        CacheStats stats() const override
+        {
+            CacheStats result;
+
+            result.name = name();
+            result.approxBytes = sizeof(*this) - sizeof(shared);
+
+            shared.accumulate(result);
+
+            return result;
+        }
+
+        void encodeEntries(std::vector<std::pair<std::string, std::string>>& result) const override
+        {
+            if constexpr (persistable)
+                shared.forEach([&result](const Key& key, const Value& value) {
+                    std::string encodedKey;
+                    std::string encodedValue;
+
+                    if (detail::CacheCodec<Key>::encode(key, encodedKey)
+                      && detail::CacheCodec<Value>::encode(value, encodedValue))
+                        result.emplace_back(std::move(encodedKey), std::move(encodedValue));
+                });
+        }
+
+      private:
+        static constexpr bool persistable =
+          detail::CacheCodec<Key>::persistable && detail::CacheCodec<Value>::persistable;
+
+        using SharedStore = detail::ShardedStore<Key, Value, Hash, EqualTo, detail::CacheMutex>;
+        /* Context functions can be called from any thread, so its stores need a real mutex even with
+         * thread-local caches: */
+        using ContextStore = detail::ShardedStore<Key, Value, Hash, EqualTo, std::mutex>;
+
+        struct ScopeLayer : public detail::CacheLayer {
+            void clear() override
+            {
+                entries.clear();
+            }
+
+            /* Unbounded, eviction is never triggered: */
+            detail::FlatCacheTable<Key, Value, EqualTo> entries;
+        };
+
+        struct ContextLayer : public detail::CacheLayer {
+            ContextLayer()
+                : store(defaultShardCount)
+            {}
+
+            void clear() override
+            {
+                store.clear();
+            }
+
+            void setCapacity(std::size_t maxEntries) override
+            {
+                store.setCapacity(maxEntries);
+            }
+
+            ContextStore store;
+        };
+
+        /* Small interface to treat both kinds of stores alike: */
+        struct ActiveStore {
+            template <class Lookup> std::optional<Value> find(const Lookup& key, std::size_t hash)
+            {
+                return context != nullptr ? context->find(key, hash) : shared->find(key, hash);
+            }
+
+            void store(Key key, const Value& value, bool fromPersisted = false)
+            {
+                if (context != nullptr)
+                    context->store(std::move(key), value, fromPersisted);
+                else
+                    shared->store(std::move(key), value, fromPersisted);
+            }
+
+            std::size_t getCapacity() const
+            {
+                return context != nullptr ? context->getCapacity() : shared->getCapacity();
+            }
+
+            SharedStore* shared;
+            ContextStore* context;
+        };
+
+        ActiveStore activeStore()
+        {
+            Context* context = detail::selectedContext();
+
+            if (context == nullptr)
+                return {&shared, nullptr};
+            else if (auto* existing = detail::findContextLayer(*context, id()))
+                return {nullptr, &static_cast<ContextLayer*>(existing)->store};
+
+            auto& layer = detail::addContextLayer(*context, id(), std::make_unique<ContextLayer>());
+
+            return {nullptr, &static_cast<ContextLayer&>(layer).store};
+        }
+
+        ScopeLayer& scopeLayerOf(CacheScope& scope) const
+        {
+            if (auto* existing = scope.layer(id()))
+                return static_cast<ScopeLayer&>(*existing);
+
+            return static_cast<ScopeLayer&>(scope.addLayer(id(), std::make_unique<ScopeLayer>()));
+        }
+
+        template <class Lookup> static decltype(auto) toKey(const Lookup& key)
+        {
+            if constexpr (std::is_same_v<Lookup, Key>)
+                return (key);
+            else
+                return Key(key);
+        }
+
+        template <class Lookup> std::optional<Value> findPersisted(const Lookup& key, ActiveStore& store)
+        /* Decoding happens without holding the lock, as it creates expressions and might thus
+         * trigger lookups in other caches: */
+        {
+            if (store.getCapacity() == 0 || !detail::hasPersistedEntries(name()))
+                return std::nullopt;
+
+            decltype(auto) storedKey = toKey(key);
+            std::string encodedKey;
+
+            if (!detail::CacheCodec<Key>::encode(storedKey, encodedKey))
+                return std::nullopt;
+
+            const auto encodedValue = detail::findPersisted(name(), encodedKey);
+
+            if (!encodedValue)
+                return std::nullopt;
+
+            std::string_view input(*encodedValue);
+            auto value = detail::CacheCodec<Value>::decode(input);
+
+            if (!value || !input.empty())
+                return std::nullopt;
+
+            store.store(storedKey, *value, true);
+
+            return value;
         }
 
-        std::unordered_multimap<Key, Value, Hash, EqualTo> map;
-        const short address = 0;
+        SharedStore shared;
     };
 }
 
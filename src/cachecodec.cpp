@@ -0,0 +1,419 @@
+
+#include "cachecodec.h"
+#include <array>
+#include <cstring>
+#include <iterator>
+#include "base.h"
+#include "basefct.h"
+#include "constant.h"
+#include "logarithm.h"
+#include "name.h"
+#include "number.h"
+#include "numeric.h"
+#include "order.h"
+#include "power.h"
+#include "product.h"
+#include "sum.h"
+#include "symbol.h"
+#include "trigonometric.h"
+#include "undefined.h"
+#include "uniquetable.h"
+
+namespace tsym {
+    namespace {
+        enum class NumberTag : char { RATIONAL, DOUBLE };
+
+        /* Nesting limit for decoding, such that corrupt input can't overflow the stack. Cached
+         * expressions hardly ever come close to it: */
+        constexpr unsigned maxDepth = 256;
+
+        constexpr std::array<std::pair<std::string_view, Trigonometric::Type>, 7> trigonometricTypes{
+          {{"sin", Trigonometric::Type::SIN}, {"cos", Trigonometric::Type::COS}, {"tan", Trigonometric::Type::TAN},
+            {"asin", Trigonometric::Type::ASIN}, {"acos", Trigonometric::Type::ACOS},
+            {"atan", Trigonometric::Type::ATAN}, {"atan2", Trigonometric::Type::ATAN2}}};
+
+        bool isIntString(std::string_view str)
+        {
+            if (!str.empty() && str.front() == '-')
+                str.remove_prefix(1);
+
+            if (str.empty())
+                return false;
+
+            for (const char c : str)
+                if (c < '0' || c > '9')
+                    return false;
+
+            return true;
+        }
+
+        std::optional<Int> readInt(std::string_view& in)
+        {
+            const auto str = detail::readBytes(in);
+
+            if (!str || !isIntString(*str))
+                return std::nullopt;
+
+            return Int(std::string(*str));
+        }
+
+        void writeDouble(double value, std::string& out)
+        {
+            std::uint64_t bits = 0;
+
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            for (unsigned i = 0; i < sizeof(bits); ++i)
+                out.push_back(static_cast<char>((bits >> (8 * i)) & 0xffu));
+        }
+
+        std::optional<double> readDouble(std::string_view& in)
+        {
+            std::uint64_t bits = 0;
+            double value = 0.0;
+
+            if (in.size() < sizeof(bits))
+                return std::nullopt;
+
+            for (unsigned i = 0; i < sizeof(bits); ++i)
+                bits |= std::uint64_t{static_cast<unsigned char>(in[i])} << (8 * i);
+
+            in.remove_prefix(sizeof(bits));
+            std::memcpy(&value, &bits, sizeof(value));
+
+            return value;
+        }
+
+        bool encodeNumber(const Number& n, std::string& out)
+        {
+            if (n.isDouble()) {
+                out.push_back(static_cast<char>(NumberTag::DOUBLE));
+                writeDouble(n.toDouble(), out);
+            } else {
+                out.push_back(static_cast<char>(NumberTag::RATIONAL));
+                detail::writeBytes(n.numerator().str(), out);
+                detail::writeBytes(n.denominator().str(), out);
+            }
+
+            return true;
+        }
+
+        bool encodeSymbol(const Base& symbol, std::string& out)
+        {
+            const Name& name = symbol.name();
+
+            if (Symbol::isTemporary(name))
+                return false;
+
+            detail::writeBytes(name.value, out);
+            detail::writeBytes(name.subscript, out);
+            detail::writeBytes(name.superscript, out);
+            out.push_back(symbol.isPositive() ? 1 : 0);
+
+            return true;
+        }
+
+        bool encodeOperands(const BasePtrList& operands, std::string& out)
+        {
+            detail::writeVarint(operands.size(), out);
+
+            for (const auto& operand : operands)
+                if (!encode(*operand, out))
+                    return false;
+
+            return true;
+        }
+    }
+
+    class ExprDecoder {
+        /* Befriended by Base for constructing nodes without simplification. */
+      public:
+        static std::optional<BasePtr> decode(std::string_view& in, unsigned depth = 0)
+        {
+            if (in.empty() || depth > maxDepth)
+                return std::nullopt;
+
+            const auto kind = static_cast<Base::Kind>(in.front());
+
+            in.remove_prefix(1);
+
+            switch (kind) {
+                case Base::Kind::NUMERIC:
+                    return decodeNumeric(in);
+                case Base::Kind::CONSTANT:
+                    return decodeConstant(in);
+                case Base::Kind::SYMBOL:
+                    return decodeSymbol(in);
+                case Base::Kind::UNDEFINED:
+                    return Undefined::create();
+                case Base::Kind::FUNCTION:
+                    return decodeFunction(in, depth);
+                case Base::Kind::POWER:
+                case Base::Kind::PRODUCT:
+                case Base::Kind::SUM:
+                    return decodeComposite(in, kind, depth);
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        static std::optional<BasePtrList> decodeOperands(std::string_view& in, unsigned depth = 0)
+        {
+            const auto count = detail::readVarint(in);
+            BasePtrList operands;
+
+            /* Every operand takes at least one byte, which protects against absurd allocations: */
+            if (!count || *count > in.size())
+                return std::nullopt;
+
+            for (std::uint64_t i = 0; i < *count; ++i)
+                if (auto operand = decode(in, depth + 1))
+                    operands.push_back(std::move(*operand));
+                else
+                    return std::nullopt;
+
+            return operands;
+        }
+
+      private:
+        template <class T, class... Args> static BasePtr create(Args&&... args)
+        {
+            return intern(BasePtr{new const T(std::forward<Args>(args)..., Base::CtorKey{})});
+        }
+
+        static std::optional<BasePtr> decodeNumeric(std::string_view& in)
+        {
+            if (in.empty())
+                return std::nullopt;
+
+            const auto tag = static_cast<NumberTag>(in.front());
+
+            in.remove_prefix(1);
+
+            if (tag == NumberTag::DOUBLE) {
+                if (const auto value = readDouble(in))
+                    return Numeric::create(*value);
+            } else if (tag == NumberTag::RATIONAL) {
+                const auto num = readInt(in);
+                const auto denom = readInt(in);
+
+                if (num && denom && *denom > 0)
+                    return Numeric::create(Number(*num, *denom));
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<BasePtr> decodeConstant(std::string_view& in)
+        {
+            const auto name = detail::readBytes(in);
+
+            if (!name)
+                return std::nullopt;
+            else if (*name == Constant::createPi()->name().value)
+                return Constant::createPi();
+            else if (*name == Constant::createE()->name().value)
+                return Constant::createE();
+
+            return std::nullopt;
+        }
+
+        static std::optional<BasePtr> decodeSymbol(std::string_view& in)
+        {
+            const auto value = detail::readBytes(in);
+            const auto subscript = detail::readBytes(in);
+            const auto superscript = detail::readBytes(in);
+
+            if (!value || !subscript || !superscript || in.empty())
+                return std::nullopt;
+
+            const bool positive = in.front() != 0;
+            const Name name{std::string(*value), std::string(*subscript), std::string(*superscript)};
+
+            in.remove_prefix(1);
+
+            if (name.value.empty() || Symbol::isTemporary(name))
+                return std::nullopt;
+
+            return positive ? Symbol::createPositive(name) : Symbol::create(name);
+        }
+
+        static std::optional<BasePtr> decodeFunction(std::string_view& in, unsigned depth)
+        {
+            const auto name = detail::readBytes(in);
+            const auto args = name ? decodeOperands(in, depth) : std::nullopt;
+
+            if (!args)
+                return std::nullopt;
+            else if (*name == "log" && args->size() == 1)
+                return create<Logarithm>(args->front());
+
+            for (const auto& [trigoName, type] : trigonometricTypes)
+                if (*name == trigoName && args->size() == (type == Trigonometric::Type::ATAN2 ? 2 : 1))
+                    return create<Trigonometric>(*args, type);
+
+            return std::nullopt;
+        }
+
+        static std::optional<BasePtr> decodeComposite(std::string_view& in, Base::Kind kind, unsigned depth)
+        {
+            const auto operands = decodeOperands(in, depth);
+
+            if (!operands)
+                return std::nullopt;
+            else if (kind == Base::Kind::POWER && operands->size() == 2)
+                return create<Power>(operands->front(), operands->back());
+            else if (kind == Base::Kind::PRODUCT && isCanonical(*operands, kind))
+                return create<Product>(*operands);
+            else if (kind == Base::Kind::SUM && isCanonical(*operands, kind))
+                return create<Sum>(*operands);
+
+            return std::nullopt;
+        }
+
+        static bool isCanonical(const BasePtrList& operands, Base::Kind kind)
+        /* Nodes are interned without simplification, so operands that a simplified sum or product
+         * can't have would plant duplicates of existing expressions that don't compare equal by
+         * pointer. Only the nesting and the order are checked, not the full simplification. The
+         * contraction of numeric powers in products doesn't sort them, hence their exception: */
+        {
+            if (operands.size() < 2)
+                return false;
+
+            for (auto it = cbegin(operands); it != cend(operands); ++it)
+                if ((*it)->kind() == kind)
+                    return false;
+                else if (it != cbegin(operands) && !isInCorrectOrder(**std::prev(it), **it))
+                    return false;
+
+            return true;
+        }
+
+        static bool isInCorrectOrder(const Base& left, const Base& right)
+        {
+            return isCorrect(left, right) || (isNumericPower(left) && isNumericPower(right));
+        }
+    };
+}
+
+bool tsym::encode(const Base& expr, std::string& out)
+{
+    out.push_back(static_cast<char>(expr.kind()));
+
+    switch (expr.kind()) {
+        case Base::Kind::NUMERIC:
+            return encodeNumber(*expr.numericEval(), out);
+        case Base::Kind::CONSTANT:
+            detail::writeBytes(expr.name().value, out);
+            return true;
+        case Base::Kind::SYMBOL:
+            return encodeSymbol(expr, out);
+        case Base::Kind::UNDEFINED:
+            return true;
+        case Base::Kind::FUNCTION:
+            detail::writeBytes(expr.name().value, out);
+            return encodeOperands(expr.operands(), out);
+        default:
+            return encodeOperands(expr.operands(), out);
+    }
+}
+
+std::optional<tsym::BasePtr> tsym::decodeExpression(std::string_view& in)
+{
+    return ExprDecoder::decode(in);
+}
+
+std::uint64_t tsym::stableHash(std::string_view bytes)
+{
+    std::uint64_t hash = 14695981039346656037u;
+
+    for (const char byte : bytes) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 1099511628211u;
+    }
+
+    return hash;
+}
+
+void tsym::detail::writeVarint(std::uint64_t n, std::string& out)
+{
+    while (n >= 0x80u) {
+        out.push_back(static_cast<char>((n & 0x7fu) | 0x80u));
+        n >>= 7u;
+    }
+
+    out.push_back(static_cast<char>(n));
+}
+
+std::optional<std::uint64_t> tsym::detail::readVarint(std::string_view& in)
+{
+    std::uint64_t result = 0;
+
+    for (unsigned shift = 0; shift < 64 && !in.empty(); shift += 7) {
+        const auto byte = static_cast<unsigned char>(in.front());
+
+        in.remove_prefix(1);
+        /* The tenth byte can only contribute the highest bit, anything else doesn't fit: */
+        if (shift == 63 && byte > 1)
+            return std::nullopt;
+
+        result |= std::uint64_t{byte & 0x7fu} << shift;
+
+        if ((byte & 0x80u) == 0)
+            return result;
+    }
+
+    return std::nullopt;
+}
+
+void tsym::detail::writeBytes(std::string_view bytes, std::string& out)
+{
+    writeVarint(bytes.size(), out);
+    out.append(bytes);
+}
+
+std::optional<std::string_view> tsym::detail::readBytes(std::string_view& in)
+{
+    const auto size = readVarint(in);
+
+    if (!size || *size > in.size())
+        return std::nullopt;
+
+    const std::string_view result = in.substr(0, *size);
+
+    in.remove_prefix(*size);
+
+    return result;
+}
+
+bool tsym::detail::CacheCodec<tsym::BasePtr>::encode(const BasePtr& value, std::string& out)
+{
+    return tsym::encode(*value, out);
+}
+
+std::optional<tsym::BasePtr> tsym::detail::CacheCodec<tsym::BasePtr>::decode(std::string_view& in)
+{
+    return decodeExpression(in);
+}
+
+bool tsym::detail::CacheCodec<tsym::BasePtrList>::encode(const BasePtrList& value, std::string& out)
+{
+    return encodeOperands(value, out);
+}
+
+std::optional<tsym::BasePtrList> tsym::detail::CacheCodec<tsym::BasePtrList>::decode(std::string_view& in)
+{
+    return ExprDecoder::decodeOperands(in);
+}
+
+bool tsym::detail::CacheCodec<tsym::Int>::encode(const Int& value, std::string& out)
+{
+    writeBytes(value.str(), out);
+
+    return true;
+}
+
+std::optional<tsym::Int> tsym::detail::CacheCodec<tsym::Int>::decode(std::string_view& in)
+{
+    return readInt(in);
+}
@@ -0,0 +1,86 @@
+#ifndef TSYM_CACHECODEC_H
+#define TSYM_CACHECODEC_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "baseptr.h"
+#include "baseptrlist.h"
+#include "int.h"
+
+namespace tsym {
+    /* Compact binary encoding of expressions for persisting cache contents across processes. The
+     * result neither depends on memory addresses nor on hash functions that might differ between
+     * runs. Nodes are written in prefix order, and decoding restores them directly, i.e., without
+     * simplifying them again, which is why encoded data must stem from the same library version.
+     * Temporary symbols are only unique within a process, so encoding them fails. */
+    bool encode(const Base& expr, std::string& out);
+    /* Consumes the decoded bytes from the input, returns std::nullopt for malformed data, including
+     * sums and products that aren't in simplified order and nesting beyond a fixed depth: */
+    std::optional<BasePtr> decodeExpression(std::string_view& in);
+
+    /* 64 bit FNV-1a hash, identical on every platform and in every run: */
+    std::uint64_t stableHash(std::string_view bytes);
+
+    namespace detail {
+        /* Primitives for the file format, too. Integers are stored as little endian base 128
+         * varints, byte sequences are prefixed by their length: */
+        void writeVarint(std::uint64_t n, std::string& out);
+        std::optional<std::uint64_t> readVarint(std::string_view& in);
+        void writeBytes(std::string_view bytes, std::string& out);
+        std::optional<std::string_view> readBytes(std::string_view& in);
+
+        /* Specializations enable persistence of RegisteredCache instances with these key and value
+         * types. They must be visible wherever a cache is instantiated, hence their declaration
+         * here and not in the implementation files that use them. */
+        template <class T> struct CacheCodec {
+            static constexpr bool persistable = false;
+        };
+
+        template <> struct CacheCodec<BasePtr> {
+            static constexpr bool persistable = true;
+            static bool encode(const BasePtr& value, std::string& out);
+            static std::optional<BasePtr> decode(std::string_view& in);
+        };
+
+        template <> struct CacheCodec<BasePtrList> {
+            static constexpr bool persistable = true;
+            static bool encode(const BasePtrList& value, std::string& out);
+            static std::optional<BasePtrList> decode(std::string_view& in);
+        };
+
+        template <> struct CacheCodec<Int> {
+            static constexpr bool persistable = true;
+            static bool encode(const Int& value, std::string& out);
+            static std::optional<Int> decode(std::string_view& in);
+        };
+
+        template <class S, class T> struct CacheCodec<std::pair<S, T>> {
+            static constexpr bool persistable = CacheCodec<S>::persistable && CacheCodec<T>::persistable;
+
+            static bool encode(const std::pair<S, T>& value, std::string& out)
+            {
+                return CacheCodec<S>::encode(value.first, out) && CacheCodec<T>::encode(value.second, out);
+            }
+
+            static std::optional<std::pair<S, T>> decode(std::string_view& in)
+            {
+                auto first = CacheCodec<S>::decode(in);
+
+                if (!first)
+                    return std::nullopt;
+
+                auto second = CacheCodec<T>::decode(in);
+
+                if (!second)
+                    return std::nullopt;
+
+                return std::make_pair(std::move(*first), std::move(*second));
+            }
+        };
+    }
+}
+
+#endif
@@ -2,13 +2,13 @@
 #include "constant.h"
 #include <cmath>
 #include "basefct.h"
-#include "basetypestr.h"
 #include "fraction.h"
 #include "numeric.h"
 #include "symbolmap.h"
+#include "uniquetable.h"
 
 tsym::Constant::Constant(Type type, Name&& name, Base::CtorKey&&)
-    : Base(typestring::constant)
+    : Base(Kind::CONSTANT, std::hash<Name>{}(name), true, orderKey(name))
     , type(type)
     , constantName{std::move(name)}
 {
@@ -31,7 +31,7 @@ const tsym::BasePtr& tsym::Constant::createE()
 
 tsym::BasePtr tsym::Constant::create(Type type, Name&& name)
 {
-    return std::make_shared<const Constant>(type, std::move(name), Base::CtorKey{});
+    return intern(BasePtr{new const Constant(type, std::move(name), Base::CtorKey{})});
 }
 
 bool tsym::Constant::isEqualDifferentBase(const Base& other) const
@@ -42,7 +42,7 @@ bool tsym::Constant::isEqualDifferentBase(const Base& other) const
         return false;
 }
 
-std::optional<tsym::Number> tsym::Constant::numericEval() const
+std::optional<tsym::Number> tsym::Constant::computeNumericEval() const
 {
     switch (type) {
         case Type::PI:
@@ -66,24 +66,17 @@ tsym::BasePtr tsym::Constant::diffWrtSymbol(const Base&) const
     return Numeric::zero();
 }
 
-bool tsym::Constant::isPositive() const
+bool tsym::Constant::computeIsPositive() const
 {
     return true;
 }
 
-bool tsym::Constant::isNegative() const
+bool tsym::Constant::computeIsNegative() const
 {
     return false;
 }
 
-size_t tsym::Constant::hash() const
-{
-    using EnumType = std::underlying_type<Type>::type;
-
-    return std::hash<EnumType>{}(static_cast<EnumType>(type));
-}
-
-unsigned tsym::Constant::complexity() const
+unsigned tsym::Constant::computeComplexity() const
 {
     return 4;
 }
@@ -24,17 +24,17 @@ namespace tsym {
         ~Constant() override = default;
 
         bool isEqualDifferentBase(const Base& other) const override;
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap& map) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
-        size_t hash() const override;
 
         const Name& name() const override;
 
       private:
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+
         static BasePtr create(Type type, Name&& name);
 
         const Type type;
@@ -0,0 +1,175 @@
+
+#include "context.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace tsym {
+    namespace {
+        Context*& selectedByThread()
+        {
+            thread_local Context* context = nullptr;
+
+            return context;
+        }
+
+        struct Contexts {
+            /* All instances but the global one, which has no layers: */
+            std::mutex mutex;
+            std::vector<Context*> instances;
+        };
+
+        Contexts& contexts()
+        /* Never destroyed, as caches with static storage duration might be destroyed later and
+         * remove their layers then: */
+        {
+            static auto* contexts = new Contexts;
+
+            return *contexts;
+        }
+
+        const PrimeResolution& intern(Int limit)
+        /* The number of distinct values is bounded by the calls to setMaxPrimeResolution, which
+         * are rare, hence interned values are simply kept: */
+        {
+            static std::mutex mutex;
+            static std::map<Int, PrimeResolution> resolutions;
+            const std::lock_guard<std::mutex> lock(mutex);
+            const std::size_t hash = boost::hash<Int>{}(limit);
+
+            return resolutions.try_emplace(limit, PrimeResolution{limit, hash}).first->second;
+        }
+    }
+}
+
+tsym::Context::Context()
+    : Context(global().primeResolution())
+{
+    const std::lock_guard<std::mutex> lock(contexts().mutex);
+
+    contexts().instances.push_back(this);
+}
+
+tsym::Context::Context(const PrimeResolution& maxPrimeResolution)
+    : maxPrimeResolution(&maxPrimeResolution)
+{}
+
+tsym::Context::~Context()
+{
+    if (this == &global())
+        return;
+
+    const std::lock_guard<std::mutex> lock(contexts().mutex);
+    auto& instances = contexts().instances;
+
+    instances.erase(std::remove(begin(instances), end(instances), this), end(instances));
+}
+
+tsym::Context& tsym::Context::global()
+{
+    static Context context(intern(Int(1000)));
+
+    return context;
+}
+
+tsym::Context& tsym::Context::current()
+{
+    Context* selected = selectedByThread();
+
+    return selected == nullptr ? global() : *selected;
+}
+
+tsym::Context::Selection::Selection(Context& context)
+    : previous(std::exchange(selectedByThread(), &context))
+{}
+
+tsym::Context::Selection::~Selection()
+{
+    selectedByThread() = previous;
+}
+
+tsym::Int tsym::Context::getMaxPrimeResolution() const
+{
+    return primeResolution().limit;
+}
+
+void tsym::Context::setMaxPrimeResolution(Int max)
+{
+    maxPrimeResolution.store(&intern(std::move(max)), std::memory_order_release);
+}
+
+const tsym::PrimeResolution& tsym::Context::primeResolution() const
+{
+    return *maxPrimeResolution.load(std::memory_order_acquire);
+}
+
+void tsym::Context::clearCaches()
+{
+    if (this == &global()) {
+        clearRegisteredCaches();
+        return;
+    }
+
+    /* Layers are cleared instead of being destroyed, as other threads might currently use them: */
+    const std::shared_lock<std::shared_mutex> lock(layersMutex);
+
+    for (auto& [id, layer] : layers)
+        layer->clear();
+}
+
+void tsym::Context::setCacheCapacity(std::size_t maxEntries)
+{
+    if (this == &global()) {
+        setRegisteredCacheCapacity(maxEntries);
+        return;
+    }
+
+    const std::lock_guard<std::shared_mutex> lock(layersMutex);
+
+    cacheCapacity = maxEntries;
+
+    for (auto& [id, layer] : layers)
+        layer->setCapacity(maxEntries);
+}
+
+tsym::Context::SymbolPool& tsym::Context::symbolPool()
+{
+    return pool;
+}
+
+tsym::Context* tsym::detail::selectedContext()
+{
+    Context* selected = selectedByThread();
+
+    /* The global context owns the shared caches, i.e., it has no layers of its own: */
+    return selected == &Context::global() ? nullptr : selected;
+}
+
+tsym::detail::CacheLayer* tsym::detail::findContextLayer(const Context& context, std::size_t cacheId)
+{
+    const std::shared_lock<std::shared_mutex> lock(context.layersMutex);
+    const auto lookup = context.layers.find(cacheId);
+
+    return lookup == cend(context.layers) ? nullptr : lookup->second.get();
+}
+
+tsym::detail::CacheLayer& tsym::detail::addContextLayer(Context& context, std::size_t cacheId,
+  std::unique_ptr<CacheLayer> layer)
+{
+    const std::lock_guard<std::shared_mutex> lock(context.layersMutex);
+
+    layer->setCapacity(context.cacheCapacity);
+
+    return *context.layers.emplace(cacheId, std::move(layer)).first->second;
+}
+
+void tsym::detail::removeContextLayers(std::size_t cacheId)
+{
+    const std::lock_guard<std::mutex> lock(contexts().mutex);
+
+    for (Context* context : contexts().instances) {
+        const std::lock_guard<std::shared_mutex> layersLock(context->layersMutex);
+
+        context->layers.erase(cacheId);
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef TSYM_CONTEXT_H
+#define TSYM_CONTEXT_H
+
+#include <boost/functional/hash.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include "baseptr.h"
+#include "cache.h"
+#include "int.h"
+#include "name.h"
+#include "options.h"
+
+namespace tsym {
+    class Context {
+        /* Owner of the options, the registered cache entries and the symbol pool used by the
+         * computations of a thread. Without any selection, threads use the global context, whose
+         * caches are the shared ones controlled by the free functions in cache.h. Any other
+         * instance keeps its own entries of every registered cache, such that computations with
+         * different options or from different tenants neither see each other's results nor
+         * contend for the same locks. A context can be selected by several threads at once, and
+         * all member functions can be called concurrently. It must outlive all computations that
+         * use it. Entries of a CacheScope still take precedence over those of the context.
+         * Expression nodes themselves are hash consed process-wide (see uniquetable.h), which is
+         * safe as they are immutable and independent of options. */
+      public:
+        /* Starts with the options of the global context and an empty set of caches: */
+        Context();
+        Context(const Context&) = delete;
+        Context& operator=(const Context&) = delete;
+        Context(Context&&) = delete;
+        Context& operator=(Context&&) = delete;
+        ~Context();
+
+        static Context& global();
+        /* The context selected by the calling thread, or the global one: */
+        static Context& current();
+
+        class Selection {
+            /* Selects the given context for the constructing thread during the lifetime of the
+             * instance and restores the previous one afterwards. Selections can be nested and
+             * must be destroyed in reverse order of their construction. */
+          public:
+            explicit Selection(Context& context);
+            Selection(const Selection&) = delete;
+            Selection& operator=(const Selection&) = delete;
+            Selection(Selection&&) = delete;
+            Selection& operator=(Selection&&) = delete;
+            ~Selection();
+
+          private:
+            Context* const previous;
+        };
+
+        /* Selection for a single call: */
+        template <class Fct> decltype(auto) run(Fct&& fct)
+        {
+            const Selection selection(*this);
+
+            return std::forward<Fct>(fct)();
+        }
+
+        Int getMaxPrimeResolution() const;
+        void setMaxPrimeResolution(Int max);
+        const PrimeResolution& primeResolution() const;
+
+        /* Same as the free functions in cache.h, but for the entries of this context only: */
+        void clearCaches();
+        void setCacheCapacity(std::size_t maxEntries);
+
+        /* Symbols with identical name and sign are only constructed once per context: */
+        struct SymbolPool {
+            using Key = std::pair<Name, bool>;
+
+            std::mutex mutex;
+            std::unordered_map<Key, BasePtr, boost::hash<Key>> symbols;
+        };
+
+        SymbolPool& symbolPool();
+
+      private:
+        explicit Context(const PrimeResolution& maxPrimeResolution);
+
+        friend detail::CacheLayer* detail::findContextLayer(const Context&, std::size_t);
+        friend detail::CacheLayer& detail::addContextLayer(Context&, std::size_t, std::unique_ptr<detail::CacheLayer>);
+        friend void detail::removeContextLayers(std::size_t);
+
+        /* Options are read on every simplification, but hardly ever changed. Each distinct value
+         * is interned once, such that reading them is a single atomic load: */
+        std::atomic<const PrimeResolution*> maxPrimeResolution;
+        /* Layers are added on first use and removed with their cache instance, lookups are by far
+         * the common case. The mutex guards the capacity, too: */
+        mutable std::shared_mutex layersMutex;
+        std::size_t cacheCapacity = detail::defaultCacheCapacity;
+        std::unordered_map<std::size_t, std::unique_ptr<detail::CacheLayer>> layers;
+        SymbolPool pool;
+    };
+}
+
+#endif
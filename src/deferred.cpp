@@ -0,0 +1,144 @@
+
+#include "deferred.h"
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "baseptrlist.h"
+#include "power.h"
+#include "product.h"
+#include "sum.h"
+
+struct tsym::DeferredVar::Node {
+    Operation operation = Operation::LEAF;
+    std::vector<std::shared_ptr<Node>> operands{};
+    /* The leaf value or, once simplified, the result: */
+    Var value{};
+    std::once_flag simplification{};
+    bool simplified = false;
+};
+
+tsym::DeferredVar::DeferredVar(const Var& value)
+    : node(std::make_shared<Node>())
+{
+    node->value = value;
+    node->simplified = true;
+}
+
+tsym::DeferredVar::DeferredVar(int value)
+    : DeferredVar(Var(value))
+{}
+
+tsym::DeferredVar::DeferredVar(Operation operation, std::shared_ptr<Node> first, std::shared_ptr<Node> second)
+    : node(std::make_shared<Node>())
+{
+    node->operation = operation;
+    node->operands = {std::move(first), std::move(second)};
+}
+
+tsym::DeferredVar& tsym::DeferredVar::operator+=(const DeferredVar& rhs)
+{
+    append(Operation::SUM, rhs.node);
+
+    return *this;
+}
+
+tsym::DeferredVar& tsym::DeferredVar::operator-=(const DeferredVar& rhs)
+{
+    append(Operation::SUM, (-rhs).node);
+
+    return *this;
+}
+
+tsym::DeferredVar& tsym::DeferredVar::operator*=(const DeferredVar& rhs)
+{
+    append(Operation::PRODUCT, rhs.node);
+
+    return *this;
+}
+
+tsym::DeferredVar& tsym::DeferredVar::operator/=(const DeferredVar& rhs)
+{
+    append(Operation::PRODUCT, pow(rhs, -1).node);
+
+    return *this;
+}
+
+void tsym::DeferredVar::append(Operation operation, std::shared_ptr<Node> operand)
+/* Nodes that are shared with other instances or parent nodes are immutable, and so are simplified
+ * ones. Powers are binary anyhow: */
+{
+    if (node->operation == operation && operation != Operation::POWER && !node->simplified && node.use_count() == 1)
+        node->operands.push_back(std::move(operand));
+    else
+        *this = DeferredVar(operation, std::move(node), std::move(operand));
+}
+
+tsym::DeferredVar tsym::DeferredVar::operator-() const
+{
+    return DeferredVar(Operation::PRODUCT, DeferredVar(-1).node, node);
+}
+
+const tsym::Var& tsym::DeferredVar::get() const
+{
+    return evaluate(*node);
+}
+
+const tsym::Var& tsym::DeferredVar::evaluate(Node& node)
+/* Operands shared by several parents are simplified only once, and after the simplification, the
+ * operands aren't needed anymore, such that the raw tree doesn't outlive its result: */
+{
+    std::call_once(node.simplification, [&node]() {
+        if (node.simplified)
+            return;
+
+        BasePtrList operands;
+
+        for (const auto& operand : node.operands)
+            operands.push_back(evaluate(*operand).get());
+
+        if (node.operation == Operation::SUM)
+            node.value = Var(Sum::createLikeStepwise(operands));
+        else if (node.operation == Operation::PRODUCT)
+            node.value = Var(Product::createLikeStepwise(operands));
+        else
+            node.value = Var(Power::create(operands.front(), operands.back()));
+
+        node.operands.clear();
+        node.simplified = true;
+    });
+
+    return node.value;
+}
+
+tsym::DeferredVar tsym::operator+(DeferredVar lhs, const DeferredVar& rhs)
+{
+    lhs += rhs;
+
+    return lhs;
+}
+
+tsym::DeferredVar tsym::operator-(DeferredVar lhs, const DeferredVar& rhs)
+{
+    lhs -= rhs;
+
+    return lhs;
+}
+
+tsym::DeferredVar tsym::operator*(DeferredVar lhs, const DeferredVar& rhs)
+{
+    lhs *= rhs;
+
+    return lhs;
+}
+
+tsym::DeferredVar tsym::operator/(DeferredVar lhs, const DeferredVar& rhs)
+{
+    lhs /= rhs;
+
+    return lhs;
+}
+
+tsym::DeferredVar tsym::pow(const DeferredVar& base, const DeferredVar& exp)
+{
+    return DeferredVar(DeferredVar::Operation::POWER, base.node, exp.node);
+}
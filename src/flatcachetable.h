@@ -0,0 +1,242 @@
+#ifndef TSYM_FLATCACHETABLE_H
+#define TSYM_FLATCACHETABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace tsym {
+    namespace detail {
+        template <class Key, class Value, class EqualTo> class FlatCacheTable {
+            /* Open addressing hash table for the shards of the registered caches. Entries live in a
+             * dense array and keep their index until they are erased, which is what the index of weak
+             * cache entries refers to. The probing array only holds the full hash and the entry index
+             * per slot, such that most mismatches are sorted out without touching the entry, and
+             * growing never needs to hash a key again. Collisions are resolved by linear probing with
+             * backward shift deletion, i.e., there are no tombstones. Instead of an exact least
+             * recently used order, every entry has a reference bit that lookups set, and the clock
+             * algorithm picks eviction victims among entries whose bit is cleared. The table isn't
+             * thread-safe, and hashes are computed by the caller, as the shard selection needs them,
+             * too. */
+          public:
+            using Index = std::uint32_t;
+
+            static constexpr Index noIndex = std::numeric_limits<Index>::max();
+
+            struct Entry {
+                Key key;
+                Value value;
+            };
+
+            /* Returns nullptr if there is no such key, the argument only needs to be comparable with
+             * Key by EqualTo: */
+            template <class Lookup> Entry* find(const Lookup& key, std::size_t hash)
+            {
+                if (const Index index = indexOf(key, hash); index != noIndex) {
+                    items[index].referenced = true;
+                    return &items[index].entry;
+                }
+
+                return nullptr;
+            }
+
+            /* Probes only once, for both the lookup of an existing entry and the insertion. Returns
+             * the index of the entry with the given key and whether it was newly inserted. The key
+             * is only copied or moved from if a new entry is inserted: */
+            template <class StoredKey>
+            std::pair<Index, bool> tryEmplace(StoredKey&& key, std::size_t hash, const Value& value)
+            {
+                if ((count + 1) * maxLoadDenominator > slots.size() * maxLoadNumerator)
+                    grow();
+
+                const std::size_t mask = slots.size() - 1;
+
+                for (std::size_t pos = home(hash);; pos = (pos + 1) & mask) {
+                    Slot& slot = slots[pos];
+
+                    if (slot.index == noIndex) {
+                        slot = Slot{hash, allocate(Key(std::forward<StoredKey>(key)), hash, value)};
+                        ++count;
+                        return {slot.index, true};
+                    } else if (slot.hash == hash && EqualTo{}(items[slot.index].entry.key, key))
+                        return {slot.index, false};
+                }
+            }
+
+            void erase(Index index)
+            {
+                const std::size_t mask = slots.size() - 1;
+                std::size_t pos = home(items[index].hash);
+
+                while (slots[pos].index != index)
+                    pos = (pos + 1) & mask;
+
+                for (std::size_t next = (pos + 1) & mask; slots[next].index != noIndex; next = (next + 1) & mask)
+                    /* Shift back all slots that would otherwise be unreachable from their home: */
+                    if (((next - home(slots[next].hash)) & mask) >= ((next - pos) & mask)) {
+                        slots[pos] = slots[next];
+                        pos = next;
+                    }
+
+                slots[pos].index = noIndex;
+                items[index] = Item{};
+                freeItems.push_back(index);
+                --count;
+            }
+
+            /* The next entry to evict other than the spared one, e.g. an entry that was just inserted.
+             * Only to be called if there is such an entry: */
+            Index victim(Index spared)
+            {
+                for (;; hand = (hand + 1) % items.size()) {
+                    Item& item = items[hand];
+
+                    if (!item.used || hand == spared)
+                        continue;
+                    else if (item.referenced)
+                        item.referenced = false;
+                    else
+                        return static_cast<Index>(hand);
+                }
+            }
+
+            Entry& entry(Index index)
+            {
+                return items[index].entry;
+            }
+
+            std::size_t size() const
+            {
+                return count;
+            }
+
+            void clear()
+            {
+                std::vector<Slot>().swap(slots);
+                std::vector<Item>().swap(items);
+                std::vector<Index>().swap(freeItems);
+                count = 0;
+                hand = 0;
+            }
+
+            template <class Fct> void forEach(Fct&& fct) const
+            {
+                for (std::size_t index = 0; index < items.size(); ++index)
+                    if (items[index].used)
+                        fct(static_cast<Index>(index), items[index].entry);
+            }
+
+            /* Heap memory of the table, excluding memory owned by keys and values: */
+            std::size_t footprint() const
+            {
+                return slots.capacity() * sizeof(Slot) + items.capacity() * sizeof(Item)
+                  + freeItems.capacity() * sizeof(Index);
+            }
+
+          private:
+            static constexpr std::size_t minSlots = 16;
+            static constexpr std::size_t maxLoadNumerator = 7;
+            static constexpr std::size_t maxLoadDenominator = 8;
+
+            struct Slot {
+                std::size_t hash = 0;
+                Index index = noIndex;
+            };
+
+            struct Item {
+                /* Not copyable, such that growing the vector moves entries even if that could
+                 * throw. A copy would acquire references that weak entries don't own: */
+                Item() = default;
+                Item(Entry newEntry, std::size_t entryHash)
+                    : entry(std::move(newEntry))
+                    , hash(entryHash)
+                    , used(true)
+                {}
+
+                Item(const Item&) = delete;
+                Item& operator=(const Item&) = delete;
+                Item(Item&&) = default;
+                Item& operator=(Item&&) = default;
+                ~Item() = default;
+
+                Entry entry{};
+                std::size_t hash = 0;
+                bool used = false;
+                bool referenced = false;
+            };
+
+            std::size_t home(std::size_t hash) const
+            /* Fibonacci hashing, which takes the high bits of the product, such that the slot doesn't
+             * correlate with the shard that was selected by the low bits of the same hash: */
+            {
+                return static_cast<std::size_t>((std::uint64_t{hash} * 0x9e3779b97f4a7c15u) >> (64u - slotBits));
+            }
+
+            template <class Lookup> Index indexOf(const Lookup& key, std::size_t hash) const
+            {
+                if (count == 0)
+                    return noIndex;
+
+                const std::size_t mask = slots.size() - 1;
+
+                for (std::size_t pos = home(hash); slots[pos].index != noIndex; pos = (pos + 1) & mask)
+                    if (slots[pos].hash == hash && EqualTo{}(items[slots[pos].index].entry.key, key))
+                        return slots[pos].index;
+
+                return noIndex;
+            }
+
+            Index allocate(Key&& key, std::size_t hash, const Value& value)
+            {
+                Index index = 0;
+
+                if (freeItems.empty()) {
+                    index = static_cast<Index>(items.size());
+                    items.emplace_back();
+                } else {
+                    index = freeItems.back();
+                    freeItems.pop_back();
+                }
+
+                items[index] = Item(Entry{std::move(key), value}, hash);
+
+                return index;
+            }
+
+            void grow()
+            {
+                std::vector<Slot> old(std::max(minSlots, 2 * slots.size()));
+
+                old.swap(slots);
+                slotBits = 0;
+
+                while ((std::size_t{1} << slotBits) < slots.size())
+                    ++slotBits;
+
+                const std::size_t mask = slots.size() - 1;
+
+                for (const Slot& slot : old)
+                    if (slot.index != noIndex) {
+                        std::size_t pos = home(slot.hash);
+
+                        while (slots[pos].index != noIndex)
+                            pos = (pos + 1) & mask;
+
+                        slots[pos] = slot;
+                    }
+            }
+
+            std::vector<Slot> slots;
+            std::vector<Item> items;
+            std::vector<Index> freeItems;
+            std::size_t count = 0;
+            std::size_t hand = 0;
+            unsigned slotBits = 0;
+        };
+    }
+}
+
+#endif
@@ -1,13 +1,11 @@
 
 #include "function.h"
-#include <boost/functional/hash.hpp>
 #include "basefct.h"
 #include "baseptrlistfct.h"
-#include "basetypestr.h"
 #include "numeric.h"
 
 tsym::Function::Function(const BasePtrList& args, Name&& name)
-    : Base(typestring::function, args)
+    : Base(Kind::FUNCTION, args, std::hash<Name>{}(name), orderKey(name))
     , functionName{std::move(name)}
 {}
 
@@ -19,16 +17,6 @@ bool tsym::Function::isEqualDifferentBase(const Base& other) const
         return false;
 }
 
-size_t tsym::Function::hash() const
-{
-    size_t seed = 0;
-
-    boost::hash_combine(seed, functionName);
-    boost::hash_combine(seed, ops);
-
-    return seed;
-}
-
 tsym::BasePtr tsym::Function::constTerm() const
 {
     return Numeric::one();
@@ -44,7 +32,7 @@ const tsym::Name& tsym::Function::name() const
     return functionName;
 }
 
-bool tsym::Function::isConst() const
+bool tsym::Function::computeIsConst() const
 {
     return false;
 }
@@ -16,9 +16,7 @@ namespace tsym {
         Function& operator=(Function&&) = delete;
 
         bool isEqualDifferentBase(const Base& other) const override;
-        size_t hash() const override;
 
-        bool isConst() const override;
         BasePtr constTerm() const override;
         BasePtr nonConstTerm() const override;
         const Name& name() const override;
@@ -28,6 +26,8 @@ namespace tsym {
         ~Function() override = default;
 
       private:
+        bool computeIsConst() const override;
+
         const Name functionName;
     };
 }
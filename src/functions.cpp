@@ -43,7 +43,7 @@ namespace tsym {
         {
             if (isSymbol(*ptr))
                 insertSymbolIfNotPresent(ptr, symbols);
-            else
+            else if (ptr->symbolBloom() != 0)
                 for (const auto& operand : ptr->operands())
                     collectSymbols(operand, symbols);
         }
@@ -11,6 +11,7 @@
 #include "sum.h"
 #include "symbolmap.h"
 #include "undefined.h"
+#include "uniquetable.h"
 
 tsym::Logarithm::Logarithm(const BasePtr& arg, Base::CtorKey&&)
     : Function({arg}, {"log"})
@@ -37,7 +38,7 @@ tsym::BasePtr tsym::Logarithm::create(const BasePtr& arg)
 
 tsym::BasePtr tsym::Logarithm::createInstance(const BasePtr& arg)
 {
-    return std::make_shared<const Logarithm>(arg, Base::CtorKey{});
+    return intern(BasePtr{new const Logarithm(arg, Base::CtorKey{})});
 }
 
 bool tsym::Logarithm::isInvalidArg(const Base& arg)
@@ -88,7 +89,7 @@ tsym::BasePtr tsym::Logarithm::createFromPower(const BasePtr& arg)
     return Product::create(arg->exp(), create(arg->base()));
 }
 
-std::optional<tsym::Number> tsym::Logarithm::numericEval() const
+std::optional<tsym::Number> tsym::Logarithm::computeNumericEval() const
 {
     if (const auto nArg = arg->numericEval())
         return std::log(nArg->toDouble());
@@ -113,11 +114,13 @@ tsym::BasePtr tsym::Logarithm::subst(const Base& from, const BasePtr& to) const
 {
     if (isEqual(from))
         return to;
+    else if (!mightHave(from))
+        return clone();
     else
         return create(arg->subst(from, to));
 }
 
-bool tsym::Logarithm::isPositive() const
+bool tsym::Logarithm::computeIsPositive() const
 {
     return checkSign(&Base::isPositive);
 }
@@ -129,12 +132,12 @@ bool tsym::Logarithm::checkSign(bool (Base::*method)() const) const
     return ((*argMinusOne).*method)();
 }
 
-bool tsym::Logarithm::isNegative() const
+bool tsym::Logarithm::computeIsNegative() const
 {
     return checkSign(&Base::isNegative);
 }
 
-unsigned tsym::Logarithm::complexity() const
+unsigned tsym::Logarithm::computeComplexity() const
 {
     return 6 + arg->complexity();
 }
@@ -16,15 +16,16 @@ namespace tsym {
         Logarithm& operator=(Logarithm&&) = delete;
         ~Logarithm() override = default;
 
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap& map) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
         BasePtr subst(const Base& from, const BasePtr& to) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
 
       private:
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+
         static bool isInvalidArg(const Base& arg);
         static BasePtr createInstance(const BasePtr& arg);
         static BasePtr createNumerically(const BasePtr& arg);
@@ -2,7 +2,16 @@
 #include "logger.h"
 #include <iostream>
 
-std::unique_ptr<const tsym::Logger> tsym::Logger::instance = std::make_unique<const tsym::Logger>();
+namespace tsym {
+    namespace {
+        std::shared_ptr<const Logger>& instance()
+        {
+            static std::shared_ptr<const Logger> logger = std::make_shared<const Logger>();
+
+            return logger;
+        }
+    }
+}
 
 void tsym::Logger::debug(const Message&) const
 {}
@@ -27,10 +36,11 @@ void tsym::Logger::critical(const Message& msg) const
 
 void tsym::Logger::setInstance(std::unique_ptr<const Logger> logger)
 {
-    instance = std::move(logger);
+    /* The previous instance is released outside of the exchange, its destructor might log: */
+    const auto previous = std::atomic_exchange(&instance(), std::shared_ptr<const Logger>(std::move(logger)));
 }
 
-const tsym::Logger& tsym::Logger::getInstance()
+std::shared_ptr<const tsym::Logger> tsym::Logger::getInstance()
 {
-    return *instance;
+    return std::atomic_load(&instance());
 }
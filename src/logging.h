@@ -4,6 +4,7 @@
 #include <boost/format.hpp>
 #include <cstring>
 #include <iterator>
+#include <memory>
 #include "logger.h"
 
 namespace tsym {
@@ -22,10 +23,10 @@ namespace tsym {
         "tsym", std::next(std::strrchr(__FILE__, '/')), __LINE__, tsym::detail::logFormat(__VA_ARGS__)                 \
     }
 
-#define TSYM_DEBUG(...) tsym::Logger::getInstance().debug(TSYM_LOGGING_ARGS(__VA_ARGS__))
-#define TSYM_INFO(...) tsym::Logger::getInstance().info(TSYM_LOGGING_ARGS(__VA_ARGS__))
-#define TSYM_WARNING(...) tsym::Logger::getInstance().warning(TSYM_LOGGING_ARGS(__VA_ARGS__))
-#define TSYM_ERROR(...) tsym::Logger::getInstance().error(TSYM_LOGGING_ARGS(__VA_ARGS__))
-#define TSYM_CRITICAL(...) tsym::Logger::getInstance().critical(TSYM_LOGGING_ARGS(__VA_ARGS__))
+#define TSYM_DEBUG(...) tsym::Logger::getInstance()->debug(TSYM_LOGGING_ARGS(__VA_ARGS__))
+#define TSYM_INFO(...) tsym::Logger::getInstance()->info(TSYM_LOGGING_ARGS(__VA_ARGS__))
+#define TSYM_WARNING(...) tsym::Logger::getInstance()->warning(TSYM_LOGGING_ARGS(__VA_ARGS__))
+#define TSYM_ERROR(...) tsym::Logger::getInstance()->error(TSYM_LOGGING_ARGS(__VA_ARGS__))
+#define TSYM_CRITICAL(...) tsym::Logger::getInstance()->critical(TSYM_LOGGING_ARGS(__VA_ARGS__))
 
 #endif
@@ -56,6 +56,17 @@ size_t tsym::hash_value(const Name& name)
     return seed;
 }
 
+std::uint64_t tsym::orderKey(const Name& name)
+{
+    std::uint64_t key = 0;
+
+    for (std::size_t i = 0; i < sizeof(key); ++i)
+        /* Big endian, padded with zeros, and unsigned like the comparison of std::string: */
+        key = key << 8u | (i < name.value.size() ? static_cast<unsigned char>(name.value[i]) : 0u);
+
+    return key;
+}
+
 size_t std::hash<tsym::Name>::operator()(const tsym::Name& name) const
 {
     return hash_value(name);
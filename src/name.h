@@ -1,6 +1,7 @@
 #ifndef TSYM_NAME_H
 #define TSYM_NAME_H
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -29,6 +30,9 @@ namespace tsym {
     bool operator>=(const Name& lhs, const Name& rhs);
     std::ostream& operator<<(std::ostream& stream, const Name& name);
     size_t hash_value(const Name& name);
+    /* The first eight bytes of the value, such that a comparison of two different keys yields the
+     * same result as the comparison of the names. Equal keys don't imply equal names: */
+    std::uint64_t orderKey(const Name& name);
 }
 
 namespace std {
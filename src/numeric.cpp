@@ -1,13 +1,13 @@
 
 #include "numeric.h"
 #include "basefct.h"
-#include "basetypestr.h"
 #include "fraction.h"
 #include "numberfct.h"
 #include "symbolmap.h"
+#include "uniquetable.h"
 
 tsym::Numeric::Numeric(Number&& number, Base::CtorKey&&)
-    : Base(typestring::numeric)
+    : Base(Kind::NUMERIC, std::hash<Number>{}(number), !number.isDouble())
     , number(std::move(number))
 {
     setDebugString();
@@ -15,7 +15,7 @@ tsym::Numeric::Numeric(Number&& number, Base::CtorKey&&)
 
 tsym::BasePtr tsym::Numeric::create(Number number)
 {
-    return std::make_shared<const Numeric>(std::move(number), Base::CtorKey{});
+    return intern(BasePtr{new const Numeric(std::move(number), Base::CtorKey{})});
 }
 
 namespace tsym {
@@ -82,7 +82,7 @@ bool tsym::Numeric::isEqualDifferentBase(const Base& other) const
         return false;
 }
 
-std::optional<tsym::Number> tsym::Numeric::numericEval() const
+std::optional<tsym::Number> tsym::Numeric::computeNumericEval() const
 {
     return number;
 }
@@ -100,22 +100,17 @@ tsym::BasePtr tsym::Numeric::diffWrtSymbol(const Base&) const
     return zero();
 }
 
-bool tsym::Numeric::isPositive() const
+bool tsym::Numeric::computeIsPositive() const
 {
     return number > 0;
 }
 
-bool tsym::Numeric::isNegative() const
+bool tsym::Numeric::computeIsNegative() const
 {
     return number < 0;
 }
 
-size_t tsym::Numeric::hash() const
-{
-    return std::hash<Number>{}(number);
-}
-
-unsigned tsym::Numeric::complexity() const
+unsigned tsym::Numeric::computeComplexity() const
 {
     if (isInt(number))
         return 1;
@@ -125,7 +120,7 @@ unsigned tsym::Numeric::complexity() const
         return 3;
 }
 
-bool tsym::Numeric::isConst() const
+bool tsym::Numeric::computeIsConst() const
 {
     return true;
 }
@@ -43,15 +43,9 @@ namespace tsym {
         static const BasePtr& mOne();
 
         bool isEqualDifferentBase(const Base& other) const override;
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap& map) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
-        size_t hash() const override;
 
-        bool isConst() const override;
         BasePtr numericTerm() const override;
         BasePtr nonNumericTerm() const override;
         BasePtr constTerm() const override;
@@ -60,6 +54,12 @@ namespace tsym {
         int degree(const Base& variable) const override;
 
       private:
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+        bool computeIsConst() const override;
+
         const Number number;
     };
 }
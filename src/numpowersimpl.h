@@ -70,7 +70,7 @@ namespace tsym {
         bool isPreFacNegative = false;
         PrimeFac nbPrimes;
         PrimeFac pfPrimes;
-        Int maxPrimeLimit = options::getMaxPrimeResolution();
+        Int maxPrimeLimit = options::maxPrimeResolution().limit;
     };
 }
 
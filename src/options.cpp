@@ -1,23 +1,17 @@
-
 #include "options.h"
+#include "context.h"
 
-namespace tsym {
-    namespace {
-        Int& maxPrimeResolution()
-        {
-            static Int maxPrimeResolution(1000);
-
-            return maxPrimeResolution;
-        }
-    }
+tsym::Int tsym::options::getMaxPrimeResolution()
+{
+    return Context::current().getMaxPrimeResolution();
 }
 
-const tsym::Int& tsym::options::getMaxPrimeResolution()
+void tsym::options::setMaxPrimeResolution(Int max)
 {
-    return maxPrimeResolution();
+    Context::current().setMaxPrimeResolution(std::move(max));
 }
 
-void tsym::options::setMaxPrimeResolution(Int max)
+const tsym::PrimeResolution& tsym::options::maxPrimeResolution()
 {
-    maxPrimeResolution() = std::move(max);
+    return Context::current().primeResolution();
 }
@@ -1,12 +1,23 @@
 #ifndef TSYM_OPTIONS_H
 #define TSYM_OPTIONS_H
 
+#include <cstddef>
 #include "int.h"
 
 namespace tsym {
+    struct PrimeResolution {
+        /* Interned value of the option, see Context. Instances are never released, such that
+         * references to them can be kept without any further synchronization: */
+        Int limit;
+        std::size_t hash;
+    };
+
     namespace options {
-        const Int& getMaxPrimeResolution();
+        /* All of these act on the options of the current context, see context.h: */
+        Int getMaxPrimeResolution();
         void setMaxPrimeResolution(Int max);
+        /* Lock-free and without copying the integer, for the simplification hot paths: */
+        const PrimeResolution& maxPrimeResolution();
     }
 }
 
@@ -34,6 +34,7 @@ namespace tsym {
     static bool isSymbolOrFunction(const Base& arg);
     static bool doPermuteLeftSum(const Base& left, const Base& right);
     static bool doPermuteLeftFunctionRightSymbol(const Base& left, const Base& right);
+    static bool haveDifferentNameKeys(const Base& left, const Base& right);
 }
 
 bool tsym::doPermute(const Base& left, const Base& right)
@@ -46,28 +47,33 @@ bool tsym::doPermute(const Base& left, const Base& right)
 
 bool tsym::doPermuteSameType(const Base& left, const Base& right)
 {
-    if (isSymbol(left))
-        return doPermuteBothSymbol(left, right);
-    else if (isNumeric(left))
-        return doPermuteBothNumeric(left, right);
-    else if (isPower(left))
-        return doPermuteBothPower(left, right);
-    else if (isProduct(left))
-        return doPermuteBothProduct(left, right);
-    else if (isSum(left))
-        return doPermuteBothSum(left, right);
-    else if (isConstant(left))
-        return doPermuteBothConstant(left, right);
-    else if (isFunction(left))
-        return doPermuteBothFunction(left, right);
-    else if (isUndefined(left))
-        TSYM_WARNING("Requesting order relation for an Undefined!");
+    switch (left.kind()) {
+        case Base::Kind::SYMBOL:
+            return doPermuteBothSymbol(left, right);
+        case Base::Kind::NUMERIC:
+            return doPermuteBothNumeric(left, right);
+        case Base::Kind::POWER:
+            return doPermuteBothPower(left, right);
+        case Base::Kind::PRODUCT:
+            return doPermuteBothProduct(left, right);
+        case Base::Kind::SUM:
+            return doPermuteBothSum(left, right);
+        case Base::Kind::CONSTANT:
+            return doPermuteBothConstant(left, right);
+        case Base::Kind::FUNCTION:
+            return doPermuteBothFunction(left, right);
+        case Base::Kind::UNDEFINED:
+            TSYM_WARNING("Requesting order relation for an Undefined!");
+    }
 
     return false;
 }
 
 bool tsym::doPermuteBothSymbol(const Base& left, const Base& right)
 {
+    if (haveDifferentNameKeys(left, right))
+        return left.nameOrderKey() > right.nameOrderKey();
+
     const Name& lName{left.name()};
     const Name& rName{right.name()};
 
@@ -134,6 +140,9 @@ bool tsym::doPermuteBothSum(const Base& left, const Base& right)
 
 bool tsym::doPermuteBothConstant(const Base& left, const Base& right)
 {
+    if (haveDifferentNameKeys(left, right))
+        return left.nameOrderKey() > right.nameOrderKey();
+
     const Name& lName{left.name()};
     const Name& rName{right.name()};
 
@@ -142,6 +151,9 @@ bool tsym::doPermuteBothConstant(const Base& left, const Base& right)
 
 bool tsym::doPermuteBothFunction(const Base& left, const Base& right)
 {
+    if (haveDifferentNameKeys(left, right))
+        return left.nameOrderKey() > right.nameOrderKey();
+
     const Name& lName{left.name()};
     const Name& rName{right.name()};
 
@@ -234,6 +246,9 @@ bool tsym::doPermuteLeftSum(const Base& left, const Base& right)
 
 bool tsym::doPermuteLeftFunctionRightSymbol(const Base& left, const Base& right)
 {
+    if (haveDifferentNameKeys(left, right))
+        return left.nameOrderKey() > right.nameOrderKey();
+
     const Name& lName{left.name()};
     const Name& rName{right.name()};
 
@@ -243,6 +258,13 @@ bool tsym::doPermuteLeftFunctionRightSymbol(const Base& left, const Base& right)
         return lName > rName;
 }
 
+bool tsym::haveDifferentNameKeys(const Base& left, const Base& right)
+/* Different keys imply different names and their order, which saves the virtual name() calls and
+ * the string comparisons for most pairs. Only for equal keys, the names must be compared. */
+{
+    return left.nameOrderKey() != right.nameOrderKey();
+}
+
 bool tsym::isCorrect(const Base& left, const Base& right)
 {
     return !doPermute(left, right);
@@ -39,6 +39,7 @@ namespace tsym {
         /* The central part of the algorithm described in Cohen [2003]. */
         {
             const Base& x(*L.front());
+            const BasePtrList R(std::next(cbegin(L)), cend(L));
             BasePtr quotient(Numeric::zero());
             BasePtr remainder(u);
             int m = u->degree(x);
@@ -49,7 +50,7 @@ namespace tsym {
             while (m >= n) {
                 assert(m >= 0 && n >= 0);
 
-                const auto d = poly::divide(remainder->leadingCoeff(x), v->leadingCoeff(x), rest(L));
+                const auto d = poly::divide(remainder->leadingCoeff(x), v->leadingCoeff(x), R);
 
                 if (!isZero(*d.back()))
                     return {quotient->expand(), remainder};
@@ -211,15 +212,13 @@ namespace tsym {
 
 tsym::BasePtrList tsym::poly::divide(const BasePtr& u, const BasePtr& v)
 {
-    static RegisteredCache<BasePtrList, BasePtrList> cache;
-    static auto& map(cache.map);
+    TSYM_CACHE_STORAGE RegisteredCache<BasePtrList, BasePtrList, ListHash, ListEqualTo> cache("poly::divide");
+    const ListLookup key(u, v);
 
-    if (const auto lookup = map.find({u, v}); lookup != cend(map))
-        return lookup->second;
+    if (const auto lookup = cache.find(key))
+        return *lookup;
 
-    auto result = divide(u, v, poly::listOfSymbols(*u, *v));
-
-    return map.insert({{u, v}, result})->second;
+    return cache.insert(BasePtrList(key), divide(u, v, poly::listOfSymbols(*u, *v)));
 }
 
 tsym::BasePtrList tsym::poly::divide(const BasePtr& u, const BasePtr& v, const BasePtrList& L)
@@ -267,14 +266,13 @@ int tsym::poly::unit(const Base& polynomial, const Base& x)
 
 tsym::BasePtr tsym::poly::gcd(const BasePtr& u, const BasePtr& v)
 {
-    static RegisteredCache<BasePtrList, BasePtr> cache;
-    static auto& map(cache.map);
-    const auto lookup = map.find({u, v});
+    TSYM_CACHE_STORAGE RegisteredCache<BasePtrList, BasePtr, ListHash, ListEqualTo> cache("poly::gcd");
+    const ListLookup key(u, v);
 
-    if (lookup != cend(map))
-        return lookup->second;
+    if (const auto lookup = cache.find(key))
+        return *lookup;
     else
-        return map.insert({{u, v}, gcd(u, v, defaultGcd())})->second;
+        return cache.insert(BasePtrList(key), gcd(u, v, defaultGcd()));
 }
 
 tsym::BasePtr tsym::poly::gcd(const BasePtr& u, const BasePtr& v, const Gcd& algo)
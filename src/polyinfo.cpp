@@ -4,6 +4,7 @@
 #include <boost/algorithm/cxx11/any_of.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm/find_if.hpp>
+#include <boost/range/algorithm/stable_sort.hpp>
 #include <cassert>
 #include "basefct.h"
 #include "logging.h"
@@ -106,7 +107,7 @@ namespace tsym {
         {
             if (isSymbol(arg))
                 addIfNotAlreadyStored(symbolList, arg);
-            else if (isNumeric(arg))
+            else if (arg.symbolBloom() == 0)
                 return;
             else
                 addSymbolsNonScalar(symbolList, arg);
@@ -148,7 +149,7 @@ tsym::BasePtrList tsym::poly::listOfSymbols(const Base& u, const Base& v)
     addSymbols(symbolList, u);
     addSymbols(symbolList, v);
 
-    symbolList.sort(ComparePolyVariables(u, v));
+    boost::stable_sort(symbolList, ComparePolyVariables(u, v));
 
     return symbolList;
 }
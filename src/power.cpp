@@ -5,7 +5,6 @@
 #include <limits>
 #include "basefct.h"
 #include "baseptrlistfct.h"
-#include "basetypestr.h"
 #include "logarithm.h"
 #include "logging.h"
 #include "numberfct.h"
@@ -15,9 +14,10 @@
 #include "product.h"
 #include "sum.h"
 #include "undefined.h"
+#include "uniquetable.h"
 
 tsym::Power::Power(const BasePtr& base, const BasePtr& exponent, Base::CtorKey&&)
-    : Base(typestring::power, {base, exponent})
+    : Base(Kind::POWER, {base, exponent})
     , baseRef(ops.front())
     , expRef(ops.back())
 {
@@ -76,7 +76,7 @@ tsym::BasePtr tsym::Power::createNonTrivial(const BasePtr& base, const BasePtr&
         /* Will probably never be the case, just a security check. */
         return Numeric::one();
 
-    return std::make_shared<const Power>(res.front(), res.back(), Base::CtorKey{});
+    return intern(BasePtr{new const Power(res.front(), res.back(), Base::CtorKey{})});
 }
 
 bool tsym::Power::isEqualDifferentBase(const Base& other) const
@@ -84,7 +84,7 @@ bool tsym::Power::isEqualDifferentBase(const Base& other) const
     return isEqualByTypeAndOperands(other);
 }
 
-std::optional<tsym::Number> tsym::Power::numericEval() const
+std::optional<tsym::Number> tsym::Power::computeNumericEval() const
 {
     const auto nExp = expRef->numericEval();
     const auto res = baseRef->numericEval();
@@ -110,7 +110,7 @@ tsym::BasePtr tsym::Power::diffWrtSymbol(const Base& symbol) const
     return Product::create(clone(), Sum::create(summands));
 }
 
-bool tsym::Power::isPositive() const
+bool tsym::Power::computeIsPositive() const
 {
     if (baseRef->isPositive())
         return true;
@@ -120,19 +120,14 @@ bool tsym::Power::isPositive() const
         return false;
 }
 
-bool tsym::Power::isNegative() const
+bool tsym::Power::computeIsNegative() const
 {
     /* Currently, negative powers are always resolved as e.g. (-a)^(1/3) = (-1)*a^(1/3) for product
      * bases or (-2)^(1/3) = (-1)*2^(1/3) for numeric powers. */
     return false;
 }
 
-size_t tsym::Power::hash() const
-{
-    return std::hash<BasePtrList>{}(ops);
-}
-
-unsigned tsym::Power::complexity() const
+unsigned tsym::Power::computeComplexity() const
 {
     return 5 + baseRef->complexity() + 2 * expRef->complexity();
 }
@@ -176,6 +171,8 @@ tsym::BasePtr tsym::Power::subst(const Base& from, const BasePtr& to) const
 {
     if (isEqual(from))
         return to;
+    else if (!mightHave(from))
+        return clone();
     else
         return create(baseRef->subst(from, to), expRef->subst(from, to));
 }
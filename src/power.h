@@ -23,13 +23,8 @@ namespace tsym {
         ~Power() override = default;
 
         bool isEqualDifferentBase(const Base& other) const override;
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap& map) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
-        size_t hash() const override;
 
         BasePtr expand() const override;
         BasePtr subst(const Base& from, const BasePtr& to) const override;
@@ -39,6 +34,11 @@ namespace tsym {
         BasePtr exp() const override;
 
       private:
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+
         static BasePtr createNotUndefined(const BasePtr& base, const BasePtr& exponent);
         static BasePtr createNonTrivial(const BasePtr& base, const BasePtr& exponent);
         BasePtr expandIntegerExponent() const;
@@ -10,7 +10,7 @@
 tsym::BasePtr tsym::PrimitiveGcd::gcdAlgo(const BasePtr& u, const BasePtr& v, const BasePtrList& L) const
 {
     const BasePtr x(L.front());
-    const BasePtrList R(rest(L));
+    const BasePtrList R(std::next(cbegin(L)), cend(L));
     const BasePtr uContent(poly::content(u, x, *this));
     const BasePtr vContent(poly::content(v, x, *this));
     const BasePtr d(compute(uContent, vContent, R));
@@ -145,7 +145,7 @@ namespace tsym {
                 auto summands = sum.operands();
 
                 toplevel(summands.front());
-                summands.pop_front();
+                summands.erase(cbegin(summands));
 
                 for (auto& summand : summands) {
                     if (isProductWithNegativeNumeric(summand)) {
@@ -226,12 +226,12 @@ namespace tsym {
 
                 /* Adjust the previous logic and move factors like 2/3 to numerator/denominator. */
                 const auto fracFactor = frac.first.front()->numericEval();
-                frac.first.pop_front();
+                frac.first.erase(cbegin(frac.first));
 
                 assert(fracFactor);
 
-                frac.first.push_front(Numeric::create(fracFactor->numerator()));
-                frac.second.push_front(Numeric::create(fracFactor->denominator()));
+                frac.first.insert(cbegin(frac.first), Numeric::create(fracFactor->numerator()));
+                frac.second.insert(cbegin(frac.second), Numeric::create(fracFactor->denominator()));
 
                 return frac;
             }
@@ -253,7 +253,7 @@ namespace tsym {
                 const BasePtr first = factors.front();
                 const unsigned productPrecedence = 2;
 
-                factors.pop_front();
+                factors.erase(cbegin(factors));
 
                 if (factors.empty())
                     toplevel(first);
@@ -2,19 +2,20 @@
 #include "product.h"
 #include <boost/range/algorithm/find_if.hpp>
 #include <boost/range/numeric.hpp>
+#include <iterator>
 #include <vector>
 #include "basefct.h"
 #include "baseptrlistfct.h"
-#include "basetypestr.h"
 #include "fraction.h"
 #include "power.h"
 #include "productsimpl.h"
 #include "sum.h"
 #include "symbolmap.h"
 #include "undefined.h"
+#include "uniquetable.h"
 
-tsym::Product::Product(const BasePtrList& factors, Base::CtorKey&&)
-    : Base(typestring::product, std::move(factors))
+tsym::Product::Product(BasePtrList factors, Base::CtorKey&&)
+    : Base(Kind::PRODUCT, std::move(factors))
 {
     setDebugString();
 }
@@ -28,21 +29,46 @@ tsym::BasePtr tsym::Product::create(const BasePtrList& factors)
     else if (factors.size() == 1)
         return factors.front();
     else
-        return createSimplifiedProduct(factors);
+        return createFromSimplified(simplifyProduct(factors));
 }
 
-tsym::BasePtr tsym::Product::createSimplifiedProduct(const BasePtrList& factors)
+tsym::BasePtr tsym::Product::create(BasePtrList&& factors)
 {
-    const BasePtrList res = simplifyProduct(factors);
+    if (hasUndefinedElements(factors))
+        return Undefined::create();
+    else if (hasZeroElements(factors))
+        return Numeric::zero();
+    else if (factors.size() == 1)
+        return std::move(factors.front());
+    else
+        return createFromSimplified(simplifyProduct(std::move(factors)));
+}
 
-    if (res.empty())
+tsym::BasePtr tsym::Product::createLikeStepwise(const BasePtrList& factors)
+{
+    if (factors.empty())
         return Numeric::one();
-    else if (res.size() == 1)
-        return res.front();
-    else if (needsExpansion(res))
-        return expandAsProduct(res);
+    else if (canCollectByBase(factors))
+        return create(factors);
+
+    BasePtr result = factors.front();
+
+    for (auto it = std::next(cbegin(factors)); it != cend(factors); ++it)
+        result = create(std::move(result), *it);
+
+    return result;
+}
+
+tsym::BasePtr tsym::Product::createFromSimplified(BasePtrList factors)
+{
+    if (factors.empty())
+        return Numeric::one();
+    else if (factors.size() == 1)
+        return std::move(factors.front());
+    else if (needsExpansion(factors))
+        return expandAsProduct(factors);
     else
-        return std::make_shared<const Product>(res, Base::CtorKey{});
+        return intern(BasePtr{new const Product(std::move(factors), Base::CtorKey{})});
 }
 
 bool tsym::Product::needsExpansion(const BasePtrList& factors)
@@ -66,7 +92,7 @@ bool tsym::Product::isEqualDifferentBase(const Base& other) const
     return isEqualByTypeAndOperands(other);
 }
 
-std::optional<tsym::Number> tsym::Product::numericEval() const
+std::optional<tsym::Number> tsym::Product::computeNumericEval() const
 {
     Number result(1);
 
@@ -98,7 +124,7 @@ tsym::Fraction tsym::Product::normalAndSplitIntoFraction(SymbolMap& map) const
         denominators.push_back(normalOperand.denom);
     }
 
-    return Fraction{create(numerators), create(denominators)};
+    return Fraction{create(std::move(numerators)), create(std::move(denominators))};
 }
 
 tsym::BasePtr tsym::Product::diffWrtSymbol(const Base& symbol) const
@@ -117,25 +143,20 @@ tsym::BasePtr tsym::Product::diffWrtSymbol(const Base& symbol) const
         factors.clear();
     }
 
-    return Sum::create(derivedSummands);
+    return Sum::create(std::move(derivedSummands));
 }
 
-bool tsym::Product::isPositive() const
+bool tsym::Product::computeIsPositive() const
 {
     return sign() == 1;
 }
 
-bool tsym::Product::isNegative() const
+bool tsym::Product::computeIsNegative() const
 {
     return sign() == -1;
 }
 
-size_t tsym::Product::hash() const
-{
-    return std::hash<BasePtrList>{}(ops);
-}
-
-unsigned tsym::Product::complexity() const
+unsigned tsym::Product::computeComplexity() const
 {
     return 5 + complexitySum(ops);
 }
@@ -167,23 +188,23 @@ tsym::BasePtr tsym::Product::nonNumericTerm() const
     if (isNumeric(*ops.front()))
         /* We should to go through automatic simplification again, because the factor list could be
          * e.g. of size 1. */
-        return create(rest(ops));
+        return create(BasePtrList(std::next(cbegin(ops)), cend(ops)));
     else
         return clone();
 }
 
 tsym::BasePtr tsym::Product::constTerm() const
 {
-    const BasePtrList constItems(getConstElements(ops));
+    BasePtrList constItems(getConstElements(ops));
 
-    return constItems.empty() ? Numeric::one() : create(constItems);
+    return constItems.empty() ? Numeric::one() : create(std::move(constItems));
 }
 
 tsym::BasePtr tsym::Product::nonConstTerm() const
 {
-    const BasePtrList nonConstItems(getNonConstElements(ops));
+    BasePtrList nonConstItems(getNonConstElements(ops));
 
-    return nonConstItems.empty() ? Numeric::one() : create(nonConstItems);
+    return nonConstItems.empty() ? Numeric::one() : create(std::move(nonConstItems));
 }
 
 tsym::BasePtr tsym::Product::expand() const
@@ -197,6 +218,8 @@ tsym::BasePtr tsym::Product::subst(const Base& from, const BasePtr& to) const
 
     if (isEqual(from))
         return to;
+    else if (!mightHave(from))
+        return clone();
     else
         return create(subst(ops, from, to));
 }
@@ -205,6 +228,8 @@ tsym::BasePtr tsym::Product::coeff(const Base& variable, int exp) const
 {
     if (isEqual(variable))
         return exp == 1 ? Numeric::one() : Numeric::zero();
+    else if (!mightHave(variable))
+        return exp == 0 ? clone() : Numeric::zero();
     else if (!has(variable) && exp == 0)
         return clone();
     else
@@ -226,13 +251,15 @@ tsym::BasePtr tsym::Product::coeffFactorMatch(const Base& variable, int exp) con
     if (matchingPower != cend(ops))
         factors.insert(cend(factors), ++matchingPower, cend(ops));
 
-    return create(factors);
+    return create(std::move(factors));
 }
 
 int tsym::Product::degree(const Base& variable) const
 {
     if (isEqual(variable))
         return 1;
+    else if (!mightHave(variable))
+        return 0;
     else
         return boost::accumulate(
           ops, 0, [&variable](int deg, const auto& factor) { return deg + factor->degree(variable); });
@@ -1,6 +1,7 @@
 #ifndef TSYM_PRODUCT_H
 #define TSYM_PRODUCT_H
 
+#include <type_traits>
 #include "base.h"
 #include "numeric.h"
 
@@ -8,17 +9,32 @@ namespace tsym {
     class Product : public Base {
       public:
         static BasePtr create(const BasePtrList& factors);
+        /* Moves the factors into the simplification cache: */
+        static BasePtr create(BasePtrList&& factors);
         template <class... T> static BasePtr create(T&&... args)
         {
-            return create({std::forward<T>(args)...});
+            if constexpr (sizeof...(T) == 1 && (std::is_same_v<std::decay_t<T>, BasePtrList> && ...)) {
+                /* Non-const or temporary lists, which are a better match for this template: */
+                if constexpr ((std::is_lvalue_reference_v<T> && ...)
+                  || (std::is_const_v<std::remove_reference_t<T>> && ...))
+                    return create(static_cast<const BasePtrList&>(args)...);
+                else
+                    return create(static_cast<BasePtrList&&>(args)...);
+            } else
+                return create(makeList(std::forward<T>(args)...));
         }
 
+        /* Same result as multiplying one factor after another, but with a single
+         * simplification where the order doesn't matter (see canCollectByBase). Used for flat
+         * lists of factors assembled by chained Var operators or ProductBuilder: */
+        static BasePtr createLikeStepwise(const BasePtrList& factors);
+
         template <class... T> static BasePtr minus(T&&... args)
         {
-            return create({Numeric::mOne(), std::forward<T>(args)...});
+            return create(makeList(Numeric::mOne(), std::forward<T>(args)...));
         }
 
-        explicit Product(const BasePtrList& factors, Base::CtorKey&&);
+        explicit Product(BasePtrList factors, Base::CtorKey&&);
         Product(const Product&) = delete;
         Product& operator=(const Product&) = delete;
         Product(Product&&) = delete;
@@ -26,13 +42,8 @@ namespace tsym {
         ~Product() override = default;
 
         bool isEqualDifferentBase(const Base& other) const override;
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap& map) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
-        size_t hash() const override;
 
         BasePtr numericTerm() const override;
         BasePtr nonNumericTerm() const override;
@@ -44,7 +55,12 @@ namespace tsym {
         int degree(const Base& variable) const override;
 
       private:
-        static BasePtr createSimplifiedProduct(const BasePtrList& factors);
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+
+        static BasePtr createFromSimplified(BasePtrList factors);
         static bool needsExpansion(const BasePtrList& factors);
         int sign() const;
         Fraction normalAndSplitIntoFraction(SymbolMap& map) const;
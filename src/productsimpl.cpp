@@ -2,8 +2,13 @@
 #include "productsimpl.h"
 #include <boost/functional/hash.hpp>
 #include <boost/range/algorithm/find_if.hpp>
+#include <boost/range/algorithm/stable_sort.hpp>
+#include <boost/range/algorithm_ext/erase.hpp>
 #include <boost/range/numeric.hpp>
+#include <algorithm>
 #include <cassert>
+#include <unordered_map>
+#include <vector>
 #include "basefct.h"
 #include "baseptrlistfct.h"
 #include "cache.h"
@@ -32,11 +37,10 @@ namespace tsym {
         BasePtr trigSymbReplacement(Trigonometric::Type type, const BasePtr& arg);
         BasePtr trigFunctionPowerReplacement(const BasePtr& pow, const BasePtr& sin, const BasePtr& cos);
 
-        BasePtrList simplTwoFactors(const BasePtrList& u);
+        BasePtrList simplTwoFactors(BasePtrListView u);
         BasePtrList simplTwoFactors(const BasePtr& f1, const BasePtr& f2);
         BasePtrList simplTwoFactorsWithProduct(const BasePtr& f1, const BasePtr& f2);
-        BasePtrList merge(const BasePtrList& l1, const BasePtrList& l2);
-        BasePtrList mergeNonEmpty(const BasePtrList& p, const BasePtrList& q);
+        BasePtrList merge(BasePtrListView p, BasePtrListView q);
         BasePtrList simplTwoFactorsWithoutProduct(const BasePtr& f1, const BasePtr& f2);
         BasePtrList simplTwoConst(const BasePtr& f1, const BasePtr& f2);
         BasePtrList simplTwoNumerics(const BasePtr& f1, const BasePtr& f2);
@@ -61,20 +65,24 @@ namespace tsym {
         void contractConst(BasePtrList& u);
         bool areTwoContractableConst(const BasePtr& f1, const BasePtr& f2);
         bool isContractableConst(const BasePtr& arg);
-        void contractTwoConst(BasePtrList::iterator& it1, BasePtrList::iterator& it2, BasePtrList& u);
+        bool contractTwoConst(BasePtrList& u, std::size_t i, std::size_t j);
         BasePtrList simplPreparedFactors(const BasePtrList& u);
         BasePtrList simplNPreparedFactors(const BasePtrList& u);
 
-        BasePtrList simplifyWithoutCache(const BasePtrList& origFactors)
+        BasePtrList simplifyWithoutCache(BasePtrList&& factors)
+        /* Prepares the given temporary in place and hands it on to the pairwise merge: */
         {
-            BasePtrList factors(origFactors);
-
             prepare(factors);
 
             if (factors.size() == 2)
                 return simplTwoFactors(factors);
             else
-                return simplNFactors(factors);
+                return simplNFactors(std::move(factors));
+        }
+
+        BasePtrList simplifyWithoutCache(BasePtrListView origFactors)
+        {
+            return simplifyWithoutCache(BasePtrList(std::cbegin(origFactors), std::cend(origFactors)));
         }
 
         void prepare(BasePtrList& fac)
@@ -94,9 +102,9 @@ namespace tsym {
             if (product == end(u))
                 return;
 
-            u.insert(product, cbegin((*product)->operands()), cend((*product)->operands()));
+            const BasePtr factor(*product);
 
-            u.erase(product);
+            u.insert(u.erase(product), cbegin(factor->operands()), cend(factor->operands()));
 
             extractProducts(u);
         }
@@ -118,27 +126,25 @@ namespace tsym {
             bool hasChanged = false;
             bool found;
 
-            for (auto it1 = begin(u); it1 != end(u);) {
-                auto it2 = next(it1);
+            for (std::size_t i = 0; i < u.size();) {
+                found = false;
 
-                for (found = false; it2 != end(u); ++it2)
-                    if ((check)(**it1, **it2)) {
-                        const auto res = (simpl)(*it1, *it2);
+                for (std::size_t j = i + 1; j < u.size(); ++j)
+                    if ((check)(*u[i], *u[j])) {
+                        const auto res = (simpl)(u[i], u[j]);
 
-                        if (res.size() == 2 && res.front()->isEqual(**it1) && res.back()->isEqual(**it2))
+                        if (res.size() == 2 && res.front()->isEqual(*u[i]) && res.back()->isEqual(*u[j]))
                             continue;
 
-                        it1 = u.erase(it1);
-                        u.insert(it1, cbegin(res), cend(res));
-                        std::advance(it1, -static_cast<long>(res.size()));
-                        u.erase(it2);
-                        it2 = it1;
+                        u.erase(u.nth(j));
+                        u.insert(u.erase(u.nth(i)), cbegin(res), cend(res));
+                        j = i;
 
                         hasChanged = found = true;
                     }
 
                 if (!found)
-                    ++it1;
+                    ++i;
             }
 
             if (hasChanged)
@@ -211,7 +217,7 @@ namespace tsym {
             return Power::create(Product::create(sin, Power::oneOver(cos)), pow->exp());
         }
 
-        BasePtrList simplTwoFactors(const BasePtrList& u)
+        BasePtrList simplTwoFactors(BasePtrListView u)
         {
             assert(u.size() == 2);
 
@@ -227,47 +233,48 @@ namespace tsym {
         }
 
         BasePtrList simplTwoFactorsWithProduct(const BasePtr& f1, const BasePtr& f2)
-        {
-            BasePtrList l1 = isProduct(*f1) ? f1->operands() : BasePtrList{f1};
-            BasePtrList l2 = isProduct(*f2) ? f2->operands() : BasePtrList{f2};
-
-            return merge(l1, l2);
-        }
-
-        BasePtrList merge(const BasePtrList& l1, const BasePtrList& l2)
-        {
-            if (l1.empty())
-                return l2;
-            else if (l2.empty())
-                return l1;
-            else
-                return mergeNonEmpty(l1, l2);
-        }
-
-        BasePtrList mergeNonEmpty(const BasePtrList& p, const BasePtrList& q)
-        {
-            BasePtr p1(p.front());
-            BasePtr q1(q.front());
-            const BasePtrList p1q1{p1, q1};
-            const BasePtrList q1p1{q1, p1};
-            BasePtrList pRest(rest(p));
-            BasePtrList qRest(rest(q));
-            BasePtrList res = simplTwoFactors(p1, q1);
-
-            if (res.empty())
-                return merge(pRest, qRest);
-            else if (res.size() == 1 && isOne(*res.front()))
-                return merge(pRest, qRest);
-            else if (res.size() == 1)
-                return join(std::move(res), merge(pRest, qRest));
-            else if (areEqual(res, p1q1))
-                return join(std::move(p1), merge(pRest, q));
-            else if (areEqual(res, q1p1))
-                return join(std::move(q1), merge(p, qRest));
+        /* See the same function for sums: */
+        {
+            const BasePtrList single1 = isProduct(*f1) ? BasePtrList{} : BasePtrList{f1};
+            const BasePtrList single2 = isProduct(*f2) ? BasePtrList{} : BasePtrList{f2};
+
+            return merge(isProduct(*f1) ? BasePtrListView(f1->operands()) : BasePtrListView(single1),
+              isProduct(*f2) ? BasePtrListView(f2->operands()) : BasePtrListView(single2));
+        }
+
+        BasePtrList merge(BasePtrListView p, BasePtrListView q)
+        /* Same iterative variant of Cohen's merge procedure as for sums. */
+        {
+            BasePtrList merged;
+
+            while (!p.empty() && !q.empty()) {
+                const BasePtr& p1(p.front());
+                const BasePtr& q1(q.front());
+                const BasePtrList res = simplTwoFactors(p1, q1);
+
+                if (res.empty() || (res.size() == 1 && isOne(*res.front()))) {
+                    p = rest(p);
+                    q = rest(q);
+                } else if (res.size() == 1) {
+                    merged.push_back(res.front());
+                    p = rest(p);
+                    q = rest(q);
+                } else if (isPair(res, *p1, *q1)) {
+                    merged.push_back(p1);
+                    p = rest(p);
+                } else if (isPair(res, *q1, *p1)) {
+                    merged.push_back(q1);
+                    q = rest(q);
+                } else {
+                    TSYM_ERROR("ProductSimpl: Error merging %S and %S to %S", p1, q1, res);
+                    return merged;
+                }
+            }
 
-            TSYM_ERROR("ProductSimpl: Error merging %S and %S to %S", p1, q1, res);
+            merged.insert(cend(merged), std::cbegin(p), std::cend(p));
+            merged.insert(cend(merged), std::cbegin(q), std::cend(q));
 
-            return {};
+            return merged;
         }
 
         BasePtrList simplTwoFactorsWithoutProduct(const BasePtr& f1, const BasePtr& f2)
@@ -467,7 +474,7 @@ namespace tsym {
         {
             assert(isNumericPower(*f1) && isNumericPower(*f2));
             const BasePtr newExp(Numeric::create(1, f1->exp()->numericEval()->denominator()));
-            const Int& limit(options::getMaxPrimeResolution());
+            const Int& limit = options::maxPrimeResolution().limit;
             const Int denom[] = {evalDenomExpNumerator(f1), evalDenomExpNumerator(f2)};
             const Int num[] = {evalNumExpNumerator(f1), evalNumExpNumerator(f2)};
             const Int newNum = num[0] * num[1];
@@ -520,7 +527,7 @@ namespace tsym {
          * is provided (in the example: it could be necessary to shift the integer 3 to the beginning of
          * the factor list to contract it with another integer). */
         {
-            u.sort([](const auto& bp1, const auto& bp2) { return doPermute(*bp1, *bp2); });
+            boost::stable_sort(u, [](const auto& bp1, const auto& bp2) { return doPermute(*bp1, *bp2); });
 
             contractNumerics(u);
             contractConst(u);
@@ -534,20 +541,20 @@ namespace tsym {
             const auto result = boost::accumulate(u, Number{1},
               [](const auto& n, const auto& factor) { return isNumeric(*factor) ? n * (*factor->numericEval()) : n; });
 
-            u.remove_if([](const auto& factor) { return isNumeric(*factor); });
+            boost::remove_erase_if(u, [](const auto& factor) { return isNumeric(*factor); });
 
             if (result != 1 || u.empty())
-                u.push_front(Numeric::create(result));
+                u.insert(cbegin(u), Numeric::create(result));
         }
 
         void contractConst(BasePtrList& u)
         {
-            for (auto it1 = begin(u); it1 != end(u); ++it1)
-                for (auto it2 = it1; it2 != end(u); ++it2)
-                    if (it1 == it2)
+            for (std::size_t i = 0; i < u.size(); ++i)
+                for (std::size_t j = i + 1; j < u.size();)
+                    if (areTwoContractableConst(u[i], u[j]) && contractTwoConst(u, i, j))
                         continue;
-                    else if (areTwoContractableConst(*it1, *it2))
-                        contractTwoConst(it1, it2, u);
+                    else
+                        ++j;
         }
 
         bool areTwoContractableConst(const BasePtr& f1, const BasePtr& f2)
@@ -565,18 +572,22 @@ namespace tsym {
             return false;
         }
 
-        void contractTwoConst(BasePtrList::iterator& it1, BasePtrList::iterator& it2, BasePtrList& u)
+        bool contractTwoConst(BasePtrList& u, std::size_t i, std::size_t j)
+        /* Returns true if the j-th item has been erased from the list. */
         {
-            const BasePtrList res(simplTwoConst(*it1, *it2));
+            const BasePtrList res(simplTwoConst(u[i], u[j]));
 
             if (res.size() == 1) {
-                *it1 = res.front();
-                it2 = u.erase(it2);
+                u[i] = res.front();
+                u.erase(u.nth(j));
+                return true;
             } else if (res.size() == 2) {
-                *it1 = res.front();
-                *it2 = res.back();
+                u[i] = res.front();
+                u[j] = res.back();
             } else
-                TSYM_ERROR("Error contracting %S and %S to %S", *it1, *it2, res);
+                TSYM_ERROR("Error contracting %S and %S to %S", u[i], u[j], res);
+
+            return false;
         }
 
         BasePtrList simplPreparedFactors(const BasePtrList& u)
@@ -591,39 +602,208 @@ namespace tsym {
 
         BasePtrList simplNPreparedFactors(const BasePtrList& u)
         {
-            const BasePtrList uRest(rest(u));
-            const BasePtr u1(u.front());
-            BasePtrList simplRest;
-
-            simplRest = simplifyWithoutCache(uRest);
+            const BasePtr& u1(u.front());
+            const BasePtrList simplRest = simplifyWithoutCache(rest(u));
 
             /* Again, slightly different from Cohen's algorithm: u1 can't be a product, because products
              * components have been merged into the input BasePtrList at the very beginning. */
-            return merge({u1}, simplRest);
+            return merge(BasePtrList{u1}, simplRest);
+        }
+    }
+
+    namespace {
+        /* Below this number of factors, the pairwise merge is cheaper than setting up the map: */
+        constexpr std::size_t minFactorsForCollection = 8;
+
+        bool isCollectableByBase(const BasePtr& factor)
+        /* Factors whose pairwise simplification only ever multiplies rational numerics and adds up
+         * exponents of equal bases. Constant factors like sqrt(2) or pi, trigonometric functions and
+         * fraction exponents of bases with unknown sign are contracted depending on the merge
+         * order, so these are left to the pairwise scheme. */
+        {
+            if (isNumeric(*factor))
+                return factor->numericEval()->isRational();
+            else if (factor->isConst() || isContractableTrigFctPower(*factor))
+                return false;
+
+            const BasePtr base = factor->base();
+            const BasePtr exp = factor->exp();
+
+            if (!isSymbol(*base) && !isSum(*base) && !isFunction(*base))
+                return false;
+            else if (!isNumeric(*exp))
+                return true;
+            else if (!exp->numericEval()->isRational())
+                return false;
+
+            return isInteger(*exp) || base->isPositive() || base->isNegative();
+        }
+
+        struct CollectedBase {
+            BasePtr base;
+            BasePtr first;
+            BasePtrList exponents;
+        };
+
+        void collect(const BasePtr& factor, Number& numeric, std::unordered_map<BasePtr, std::size_t>& indices,
+          std::vector<CollectedBase>& bases)
+        {
+            if (isNumeric(*factor)) {
+                numeric *= *factor->numericEval();
+                return;
+            }
+
+            const BasePtr base = factor->base();
+            const auto [lookup, inserted] = indices.try_emplace(base, bases.size());
+
+            if (inserted)
+                bases.push_back({base, factor, {factor->exp()}});
+            else
+                bases[lookup->second].exponents.push_back(factor->exp());
         }
     }
 
     namespace {
         using CacheKey = std::pair<BasePtrList, Int>;
 
+        struct CacheLookup {
+            /* Refers to the factors and the interned option, which are only copied upon insertion.
+             * The stored key holds the option value, not the interned instance, as it's persisted,
+             * see cachecodec.h: */
+            explicit operator CacheKey() const
+            {
+                return {BasePtrList(factors), maxPrimeResolution.limit};
+            }
+
+            ListLookup factors;
+            const PrimeResolution& maxPrimeResolution;
+        };
+
+        std::size_t combinedHash(std::size_t factorsHash, std::size_t maxPrimeResolutionHash)
+        /* Same as boost::hash<CacheKey>: */
+        {
+            std::size_t seed = 0;
+
+            boost::hash_combine(seed, factorsHash);
+            boost::hash_combine(seed, maxPrimeResolutionHash);
+
+            return seed;
+        }
+
+        struct CacheHash {
+            std::size_t operator()(const CacheKey& key) const
+            {
+                return combinedHash(ListHash{}(key.first), boost::hash<Int>{}(key.second));
+            }
+
+            std::size_t operator()(const CacheLookup& lookup) const
+            {
+                return combinedHash(lookup.factors.hash(), lookup.maxPrimeResolution.hash);
+            }
+        };
+
         struct CacheEqualTo {
             bool operator()(const CacheKey& lhs, const CacheKey& rhs) const
             {
                 return areEqual(lhs.first, rhs.first) && lhs.second == rhs.second;
             }
+
+            bool operator()(const CacheKey& key, const CacheLookup& lookup) const
+            {
+                return lookup.factors.matches(key.first) && key.second == lookup.maxPrimeResolution.limit;
+            }
         };
+
+        using Cache = RegisteredCache<CacheKey, BasePtrList, CacheHash, CacheEqualTo>;
+
+        Cache& cache()
+        {
+            TSYM_CACHE_STORAGE Cache instance("simplifyProduct");
+
+            return instance;
+        }
+
+        CacheKey toKey(const CacheLookup& lookup, const BasePtrList&)
+        {
+            return CacheKey(lookup);
+        }
+
+        CacheKey toKey(const CacheLookup& lookup, BasePtrList&& factors)
+        {
+            return {std::move(factors), lookup.maxPrimeResolution.limit};
+        }
+
+        template <class List> BasePtrList simplifyCached(List&& factors)
+        /* A temporary list of factors is moved into the key upon a cache miss. The result is
+         * computed beforehand, as it still refers to the factors: */
+        {
+            const CacheLookup key{ListLookup(factors), options::maxPrimeResolution()};
+
+            if (const auto lookup = cache().find(key))
+                return *lookup;
+
+            BasePtrList result = factors.size() >= minFactorsForCollection && canCollectByBase(factors) ?
+              collectByBase(factors) :
+              simplifyWithoutCache(factors);
+
+            return cache().insert(toKey(key, std::forward<List>(factors)), std::move(result));
+        }
     }
 }
 
-tsym::BasePtrList tsym::simplifyProduct(const BasePtrList& factors)
+bool tsym::canCollectByBase(const BasePtrList& factors)
 {
-    static RegisteredCache<CacheKey, BasePtrList, boost::hash<CacheKey>, CacheEqualTo> cache;
-    static const auto& relevantOption = options::getMaxPrimeResolution();
-    static auto& map(cache.map);
-    const auto key = std::make_pair(factors, relevantOption);
+    for (const auto& factor : factors)
+        if (isProduct(*factor)) {
+            for (const auto& nested : factor->operands())
+                if (!isCollectableByBase(nested))
+                    return false;
+        } else if (!isCollectableByBase(factor))
+            return false;
+
+    return true;
+}
+
+tsym::BasePtrList tsym::collectByBase(const BasePtrList& factors)
+/* Same result as the pairwise scheme for factors that pass canCollectByBase, but factors with
+ * equal bases are grouped in a hash map, their exponents are added up at once, and the result
+ * is sorted once, instead of merging the simplified rest of the factors over and over
+ * again. */
+{
+    std::unordered_map<BasePtr, std::size_t> indices;
+    std::vector<CollectedBase> bases;
+    Number numeric(1);
+    BasePtrList result;
+
+    for (const auto& factor : factors)
+        if (isProduct(*factor))
+            for (const auto& nested : factor->operands())
+                collect(nested, numeric, indices, bases);
+        else
+            collect(factor, numeric, indices, bases);
+
+    if (numeric != 1)
+        result.push_back(Numeric::create(numeric));
+
+    for (const auto& collected : bases)
+        if (collected.exponents.size() == 1)
+            result.push_back(collected.first);
+        else if (const BasePtr power = Power::create(collected.base, Sum::create(collected.exponents));
+                 !isOne(*power))
+            result.push_back(power);
+
+    std::sort(begin(result), end(result),
+      [](const BasePtr& lhs, const BasePtr& rhs) { return doPermute(*rhs, *lhs); });
+
+    return result;
+}
 
-    if (const auto lookup = map.find(key); lookup != cend(map))
-        return lookup->second;
+tsym::BasePtrList tsym::simplifyProduct(const BasePtrList& factors)
+{
+    return simplifyCached(factors);
+}
 
-    return map.insert({key, simplifyWithoutCache(factors)})->second;
+tsym::BasePtrList tsym::simplifyProduct(BasePtrList&& factors)
+{
+    return simplifyCached(std::move(factors));
 }
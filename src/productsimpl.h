@@ -23,6 +23,14 @@ namespace tsym {
      * functions: sin(a)/cos(a) = tan(a) and cos(a)/sin(a) = 1/tan(a). This has to be done in
      * advance to Cohen's algorithm to ensure its proper functionality. */
     BasePtrList simplifyProduct(const BasePtrList& factors);
+    /* Moves the factors into the cache instead of copying them: */
+    BasePtrList simplifyProduct(BasePtrList&& factors);
+
+    /* Same as canCollectByTerm for sums, e.g. false for numeric powers or trigonometric
+     * functions, which are contracted depending on the order of the factors: */
+    bool canCollectByBase(const BasePtrList& factors);
+    /* Only for factors that pass canCollectByBase, same result as simplifyProduct, but uncached: */
+    BasePtrList collectByBase(const BasePtrList& factors);
 }
 
 #endif
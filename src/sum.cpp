@@ -2,10 +2,10 @@
 #include "sum.h"
 #include <boost/range/numeric.hpp>
 #include <cassert>
+#include <iterator>
 #include <limits>
 #include "basefct.h"
 #include "baseptrlistfct.h"
-#include "basetypestr.h"
 #include "fraction.h"
 #include "numberfct.h"
 #include "numeric.h"
@@ -14,9 +14,10 @@
 #include "product.h"
 #include "sumsimpl.h"
 #include "undefined.h"
+#include "uniquetable.h"
 
-tsym::Sum::Sum(const BasePtrList& summands, Base::CtorKey&&)
-    : Base(typestring::sum, summands)
+tsym::Sum::Sum(BasePtrList summands, Base::CtorKey&&)
+    : Base(Kind::SUM, std::move(summands))
 {
     setDebugString();
 }
@@ -28,19 +29,42 @@ tsym::BasePtr tsym::Sum::create(const BasePtrList& summands)
     else if (summands.size() == 1)
         return summands.front();
     else
-        return createSimplifiedSum(summands);
+        return createFromSimplified(simplifySum(summands));
 }
 
-tsym::BasePtr tsym::Sum::createSimplifiedSum(const BasePtrList& summands)
+tsym::BasePtr tsym::Sum::create(BasePtrList&& summands)
 {
-    const auto res = simplifySum(summands);
+    if (hasUndefinedElements(summands))
+        return Undefined::create();
+    else if (summands.size() == 1)
+        return std::move(summands.front());
+    else
+        return createFromSimplified(simplifySum(std::move(summands)));
+}
+
+tsym::BasePtr tsym::Sum::createLikeStepwise(const BasePtrList& summands)
+{
+    if (summands.empty())
+        return Numeric::zero();
+    else if (canCollectByTerm(summands))
+        return create(summands);
+
+    BasePtr result = summands.front();
+
+    for (auto it = std::next(cbegin(summands)); it != cend(summands); ++it)
+        result = create(std::move(result), *it);
 
-    if (res.empty())
+    return result;
+}
+
+tsym::BasePtr tsym::Sum::createFromSimplified(BasePtrList summands)
+{
+    if (summands.empty())
         return Numeric::zero();
-    else if (res.size() == 1)
-        return res.front();
+    else if (summands.size() == 1)
+        return std::move(summands.front());
     else
-        return std::make_shared<const Sum>(res, Base::CtorKey{});
+        return intern(BasePtr{new const Sum(std::move(summands), Base::CtorKey{})});
 }
 
 bool tsym::Sum::isEqualDifferentBase(const Base& other) const
@@ -48,7 +72,7 @@ bool tsym::Sum::isEqualDifferentBase(const Base& other) const
     return isEqualByTypeAndOperands(other);
 }
 
-std::optional<tsym::Number> tsym::Sum::numericEval() const
+std::optional<tsym::Number> tsym::Sum::computeNumericEval() const
 {
     Number result(0);
 
@@ -107,10 +131,10 @@ tsym::BasePtr tsym::Sum::diffWrtSymbol(const Base& symbol) const
     for (const auto& summand : ops)
         derivedSummands.push_back(summand->diff(symbol));
 
-    return create(derivedSummands);
+    return create(std::move(derivedSummands));
 }
 
-bool tsym::Sum::isPositive() const
+bool tsym::Sum::computeIsPositive() const
 {
     if (const auto num = numericEval())
         return num > 0;
@@ -118,7 +142,7 @@ bool tsym::Sum::isPositive() const
     return sign() == 1;
 }
 
-bool tsym::Sum::isNegative() const
+bool tsym::Sum::computeIsNegative() const
 {
     if (const auto num = numericEval())
         return num < 0;
@@ -126,12 +150,7 @@ bool tsym::Sum::isNegative() const
     return sign() == -1;
 }
 
-size_t tsym::Sum::hash() const
-{
-    return std::hash<BasePtrList>{}(ops);
-}
-
-unsigned tsym::Sum::complexity() const
+unsigned tsym::Sum::computeComplexity() const
 {
     return 5 + complexitySum(ops);
 }
@@ -187,7 +206,7 @@ tsym::BasePtr tsym::Sum::expand() const
     for (const auto& summand : ops)
         expandedSummands.push_back(summand->expand());
 
-    return create(expandedSummands);
+    return create(std::move(expandedSummands));
 }
 
 tsym::BasePtr tsym::Sum::subst(const tsym::Base& from, const tsym::BasePtr& to) const
@@ -196,6 +215,8 @@ tsym::BasePtr tsym::Sum::subst(const tsym::Base& from, const tsym::BasePtr& to)
 
     if (isEqual(from))
         return to;
+    else if (!mightHave(from))
+        return clone();
     else
         return create(subst(ops, from, to));
 }
@@ -204,6 +225,8 @@ tsym::BasePtr tsym::Sum::coeff(const Base& variable, int exp) const
 {
     if (isEqual(variable))
         return exp == 1 ? Numeric::one() : Numeric::zero();
+    else if (!mightHave(variable))
+        return exp == 0 ? clone() : Numeric::zero();
     else if (!has(variable) && exp == 0)
         return clone();
     else
@@ -226,6 +249,8 @@ int tsym::Sum::degree(const Base& variable) const
 
     if (isEqual(variable))
         return 1;
+    else if (!mightHave(variable))
+        return 0;
     else
         return boost::accumulate(
           ops, minInt, [&variable](int deg, const auto& summand) { return std::max(deg, summand->degree(variable)); });
@@ -1,6 +1,7 @@
 #ifndef TSYM_SUM_H
 #define TSYM_SUM_H
 
+#include <type_traits>
 #include <vector>
 #include "base.h"
 
@@ -8,12 +9,27 @@ namespace tsym {
     class Sum : public Base {
       public:
         static BasePtr create(const BasePtrList& summands);
+        /* Moves the summands into the simplification cache: */
+        static BasePtr create(BasePtrList&& summands);
         template <class... T> static BasePtr create(T&&... args)
         {
-            return create({std::forward<T>(args)...});
+            if constexpr (sizeof...(T) == 1 && (std::is_same_v<std::decay_t<T>, BasePtrList> && ...)) {
+                /* Non-const or temporary lists, which are a better match for this template: */
+                if constexpr ((std::is_lvalue_reference_v<T> && ...)
+                  || (std::is_const_v<std::remove_reference_t<T>> && ...))
+                    return create(static_cast<const BasePtrList&>(args)...);
+                else
+                    return create(static_cast<BasePtrList&&>(args)...);
+            } else
+                return create(makeList(std::forward<T>(args)...));
         }
 
-        explicit Sum(const BasePtrList& summands, Base::CtorKey&&);
+        /* Same result as adding one summand after another, but with a single simplification
+         * where the order doesn't matter (see canCollectByTerm). Used for flat lists of
+         * summands assembled by the user, i.e. by chained Var operators or SumBuilder: */
+        static BasePtr createLikeStepwise(const BasePtrList& summands);
+
+        explicit Sum(BasePtrList summands, Base::CtorKey&&);
         Sum(const Sum&) = delete;
         Sum& operator=(const Sum&) = delete;
         Sum(Sum&&) = delete;
@@ -21,13 +37,8 @@ namespace tsym {
         ~Sum() override = default;
 
         bool isEqualDifferentBase(const Base& other) const override;
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap& map) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
-        size_t hash() const override;
 
         BasePtr expand() const override;
         BasePtr subst(const Base& from, const BasePtr& to) const override;
@@ -35,7 +46,12 @@ namespace tsym {
         int degree(const Base& variable) const override;
 
       private:
-        static BasePtr createSimplifiedSum(const BasePtrList& summands);
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+
+        static BasePtr createFromSimplified(BasePtrList summands);
         Fraction toCommonDenom(const std::vector<Fraction>& operands) const;
         int sign() const;
         int signOfNumericParts() const;
@@ -1,6 +1,9 @@
 
 #include "sumsimpl.h"
+#include <algorithm>
 #include <cassert>
+#include <unordered_map>
+#include <vector>
 #include "basefct.h"
 #include "baseptrlistfct.h"
 #include "cache.h"
@@ -13,11 +16,10 @@
 
 namespace tsym {
     namespace {
-        BasePtrList simplTwoSummands(const BasePtrList& u);
+        BasePtrList simplTwoSummands(BasePtrListView u);
         BasePtrList simplTwoSummands(const BasePtr& s1, const BasePtr& s2);
         BasePtrList simplTwoSummandsWithSum(const BasePtr& s1, const BasePtr& s2);
-        BasePtrList merge(const BasePtrList& l1, const BasePtrList& l2);
-        BasePtrList mergeNonEmpty(const BasePtrList& p, const BasePtrList& q);
+        BasePtrList merge(BasePtrListView p, BasePtrListView q);
         BasePtrList simplTwoSummandsWithoutSum(const BasePtr& s1, const BasePtr& s2);
         BasePtrList simplTwoNumerics(const BasePtr& s1, const BasePtr& s2);
         bool haveEqualNonConstTerms(const BasePtr& s1, const BasePtr& s2);
@@ -28,9 +30,9 @@ namespace tsym {
         bool areSinAndCosSquare(const BasePtr& s1, const BasePtr& s2);
         bool areSinAndCos(const BasePtr& s1, const BasePtr& s2);
         bool haveEqualFirstOperands(const BasePtr& pow1, const BasePtr& pow2);
-        BasePtrList simplNSummands(const BasePtrList& u);
+        BasePtrList simplNSummands(BasePtrListView u);
 
-        BasePtrList simplWithoutCache(const BasePtrList& summands)
+        BasePtrList simplWithoutCache(BasePtrListView summands)
         {
             if (summands.size() == 2)
                 return simplTwoSummands(summands);
@@ -38,7 +40,7 @@ namespace tsym {
                 return simplNSummands(summands);
         }
 
-        BasePtrList simplTwoSummands(const BasePtrList& u)
+        BasePtrList simplTwoSummands(BasePtrListView u)
         {
             assert(u.size() == 2);
 
@@ -54,47 +56,49 @@ namespace tsym {
         }
 
         BasePtrList simplTwoSummandsWithSum(const BasePtr& s1, const BasePtr& s2)
+        /* The operands of sums are merged without copying them, only single summands need a list: */
         {
-            BasePtrList l1 = isSum(*s1) ? s1->operands() : BasePtrList{s1};
-            BasePtrList l2 = isSum(*s2) ? s2->operands() : BasePtrList{s2};
+            const BasePtrList single1 = isSum(*s1) ? BasePtrList{} : BasePtrList{s1};
+            const BasePtrList single2 = isSum(*s2) ? BasePtrList{} : BasePtrList{s2};
 
-            return merge(l1, l2);
+            return merge(isSum(*s1) ? BasePtrListView(s1->operands()) : BasePtrListView(single1),
+              isSum(*s2) ? BasePtrListView(s2->operands()) : BasePtrListView(single2));
         }
 
-        BasePtrList merge(const BasePtrList& l1, const BasePtrList& l2)
+        BasePtrList merge(BasePtrListView p, BasePtrListView q)
+        /* Cohen's recursive merge procedure, unrolled into a loop that appends to the result
+         * instead of prepending to the merged rest. */
         {
-            if (l1.empty())
-                return l2;
-            else if (l2.empty())
-                return l1;
-            else
-                return mergeNonEmpty(l1, l2);
-        }
-
-        BasePtrList mergeNonEmpty(const BasePtrList& p, const BasePtrList& q)
-        {
-            BasePtr p1(p.front());
-            BasePtr q1(q.front());
-            const BasePtrList p1q1{p1, q1};
-            const BasePtrList q1p1{q1, p1};
-            BasePtrList pRest(rest(p));
-            BasePtrList qRest(rest(q));
-            BasePtrList res = simplTwoSummands(p1, q1);
-
-            if (res.empty())
-                return merge(pRest, qRest);
-            else if (res.size() == 1 && isZero(*res.front()))
-                return merge(pRest, qRest);
-            else if (res.size() == 1)
-                return join(std::move(res), merge(pRest, qRest));
-            else if (areEqual(res, p1q1))
-                return join(std::move(p1), merge(pRest, q));
-            else if (areEqual(res, q1p1))
-                return join(std::move(q1), merge(p, qRest));
-
-            TSYM_ERROR("Error merging non-empty lists: %S, %S", p, q);
-
-            return {};
+            BasePtrList merged;
+
+            while (!p.empty() && !q.empty()) {
+                const BasePtr& p1(p.front());
+                const BasePtr& q1(q.front());
+                const BasePtrList res = simplTwoSummands(p1, q1);
+
+                if (res.empty() || (res.size() == 1 && isZero(*res.front()))) {
+                    p = rest(p);
+                    q = rest(q);
+                } else if (res.size() == 1) {
+                    merged.push_back(res.front());
+                    p = rest(p);
+                    q = rest(q);
+                } else if (isPair(res, *p1, *q1)) {
+                    merged.push_back(p1);
+                    p = rest(p);
+                } else if (isPair(res, *q1, *p1)) {
+                    merged.push_back(q1);
+                    q = rest(q);
+                } else {
+                    TSYM_ERROR("Error merging non-empty lists: %S, %S", p, q);
+                    return merged;
+                }
+            }
+
+            merged.insert(cend(merged), std::cbegin(p), std::cend(p));
+            merged.insert(cend(merged), std::cbegin(q), std::cend(q));
+
+            return merged;
         }
 
         BasePtrList simplTwoSummandsWithoutSum(const BasePtr& s1, const BasePtr& s2)
@@ -221,29 +225,138 @@ namespace tsym {
             return arg1->isEqual(*arg2) || arg1->normal()->isEqual(*arg2->normal());
         }
 
-        BasePtrList simplNSummands(const BasePtrList& u)
+        BasePtrList simplNSummands(BasePtrListView u)
         {
-            const BasePtrList uRest(rest(u));
-            const BasePtr u1(u.front());
+            const BasePtr& u1(u.front());
+            const BasePtrListView uRest(rest(u));
             const BasePtrList simplRest = simplWithoutCache(uRest);
 
             if (isSum(*u1))
                 return merge(u1->operands(), simplRest);
             else
-                return merge({u1}, simplRest);
+                return merge(BasePtrList{u1}, simplRest);
+        }
+
+        /* Below this number of summands, the pairwise merge is cheaper than setting up the map: */
+        constexpr std::size_t minSummandsForCollection = 8;
+
+        bool isCollectableByTerm(const BasePtr& summand)
+        /* Summands whose pairwise simplification only ever adds up rational coefficients of equal
+         * non-numeric terms. Constant prefactors like sqrt(2)*a and squares of sin or cos could
+         * interact with other summands in a way that depends on the merge order, and the sum of
+         * double coefficients depends on the order of additions, so these are left to the
+         * pairwise scheme. */
+        {
+            const BasePtr constTerm = summand->constTerm();
+
+            if (!isNumeric(*constTerm) || !constTerm->numericEval()->isRational())
+                return false;
+
+            const BasePtr nonConstTerm = summand->nonConstTerm();
+
+            return !isPower(*nonConstTerm) || !isFunction(*nonConstTerm->base());
+        }
+
+        struct CollectedTerm {
+            BasePtr nonNumeric;
+            BasePtr first;
+            Number coeff;
+            std::size_t count;
+        };
+
+        void collect(const BasePtr& summand, std::unordered_map<BasePtr, std::size_t>& indices,
+          std::vector<CollectedTerm>& terms)
+        {
+            const BasePtr nonNumeric = summand->nonNumericTerm();
+            const Number coeff = *summand->numericTerm()->numericEval();
+            const auto [lookup, inserted] = indices.try_emplace(nonNumeric, terms.size());
+
+            if (inserted)
+                terms.push_back({nonNumeric, summand, coeff, 1});
+            else {
+                CollectedTerm& term = terms[lookup->second];
+
+                term.coeff += coeff;
+                ++term.count;
+            }
+        }
+
+        using Cache = RegisteredCache<BasePtrList, BasePtrList>;
+
+        Cache& cache()
+        {
+            TSYM_CACHE_STORAGE Cache instance("simplifySum");
+
+            return instance;
+        }
+
+        template <class List> BasePtrList simplifyCached(List&& summands)
+        /* A temporary list of summands is moved into the key upon a cache miss, after the result
+         * has been computed from it: */
+        {
+            if (const auto lookup = cache().find(summands))
+                return *lookup;
+
+            BasePtrList result = summands.size() >= minSummandsForCollection && canCollectByTerm(summands) ?
+              collectByTerm(summands) :
+              simplWithoutCache(summands);
+
+            return cache().insert(std::forward<List>(summands), std::move(result));
         }
     }
 }
 
-tsym::BasePtrList tsym::simplifySum(const BasePtrList& summands)
+bool tsym::canCollectByTerm(const BasePtrList& summands)
 {
-    static RegisteredCache<BasePtrList, BasePtrList> cache;
-    static auto& map(cache.map);
+    for (const auto& summand : summands)
+        if (isSum(*summand)) {
+            for (const auto& nested : summand->operands())
+                if (!isCollectableByTerm(nested))
+                    return false;
+        } else if (!isCollectableByTerm(summand))
+            return false;
 
-    if (const auto lookup = map.find(summands); lookup != cend(map))
-        return lookup->second;
+    return true;
+}
 
-    const auto result = simplWithoutCache(summands);
+tsym::BasePtrList tsym::collectByTerm(const BasePtrList& summands)
+/* Same result as the pairwise scheme for summands that pass canCollectByTerm, but summands
+ * with equal non-numeric terms are grouped in a hash map and the result is sorted once,
+ * instead of merging the simplified rest of the summands over and over again. */
+{
+    std::unordered_map<BasePtr, std::size_t> indices;
+    std::vector<CollectedTerm> terms;
+    BasePtrList result;
+
+    for (const auto& summand : summands)
+        if (isSum(*summand))
+            for (const auto& nested : summand->operands())
+                collect(nested, indices, terms);
+        else
+            collect(summand, indices, terms);
+
+    for (const auto& term : terms)
+        if (term.coeff == 0)
+            continue;
+        else if (term.count == 1)
+            result.push_back(term.first);
+        else if (isOne(*term.nonNumeric))
+            result.push_back(Numeric::create(term.coeff));
+        else
+            result.push_back(Product::create(Numeric::create(term.coeff), term.nonNumeric));
+
+    std::sort(begin(result), end(result),
+      [](const BasePtr& lhs, const BasePtr& rhs) { return doPermute(*rhs, *lhs); });
+
+    return result;
+}
 
-    return map.insert({summands, result})->second;
+tsym::BasePtrList tsym::simplifySum(const BasePtrList& summands)
+{
+    return simplifyCached(summands);
+}
+
+tsym::BasePtrList tsym::simplifySum(BasePtrList&& summands)
+{
+    return simplifyCached(std::move(summands));
 }
@@ -6,6 +6,15 @@
 
 namespace tsym {
     BasePtrList simplifySum(const BasePtrList& summands);
+    /* Moves the summands into the cache instead of copying them: */
+    BasePtrList simplifySum(BasePtrList&& summands);
+
+    /* True if the summands are simplified to the same result, no matter in which order or
+     * grouping they are added. This isn't the case for e.g. constant prefactors or sin(a)^2 +
+     * cos(a)^2, where the pairwise simplification depends on which summands meet first: */
+    bool canCollectByTerm(const BasePtrList& summands);
+    /* Only for summands that pass canCollectByTerm, same result as simplifySum, but uncached: */
+    BasePtrList collectByTerm(const BasePtrList& summands);
 }
 
 #endif
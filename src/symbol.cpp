@@ -1,20 +1,35 @@
 
 #include "symbol.h"
 #include <boost/functional/hash.hpp>
-#include <unordered_map>
+#include <mutex>
 #include <utility>
 #include "basefct.h"
-#include "basetypestr.h"
 #include "cache.h"
+#include "context.h"
 #include "fraction.h"
 #include "logging.h"
 #include "numeric.h"
 #include "undefined.h"
+#include "uniquetable.h"
 
-unsigned tsym::Symbol::tmpCounter = 0;
+std::atomic<unsigned> tsym::Symbol::tmpCounter = 0;
+
+namespace tsym {
+    namespace {
+        size_t leafHash(const Name& name, bool positive)
+        {
+            size_t seed = 0;
+
+            boost::hash_combine(seed, name);
+            boost::hash_combine(seed, positive);
+
+            return seed;
+        }
+    }
+}
 
 tsym::Symbol::Symbol(Name name, bool positive, Base::CtorKey&&)
-    : Base(typestring::symbol)
+    : Base(Kind::SYMBOL, leafHash(name, positive), true, orderKey(name))
     , symbolName{std::move(name)}
     , positive(positive)
 {
@@ -22,18 +37,8 @@ tsym::Symbol::Symbol(Name name, bool positive, Base::CtorKey&&)
 }
 
 tsym::Symbol::Symbol(unsigned tmpId, bool positive, Base::CtorKey&&)
-    : Base(typestring::symbol)
-    , symbolName{std::string(tmpSymbolNamePrefix) + std::to_string(tmpId)}
-    , positive(positive)
-{
-    setDebugString();
-}
-
-tsym::Symbol::~Symbol()
-{
-    if (symbolName.value.find(tmpSymbolNamePrefix) == 0)
-        --tmpCounter;
-}
+    : Symbol(Name{std::string(tmpSymbolNamePrefix) + std::to_string(tmpId)}, positive, Base::CtorKey{})
+{}
 
 tsym::BasePtr tsym::Symbol::create(std::string_view name)
 {
@@ -50,7 +55,7 @@ tsym::BasePtr tsym::Symbol::create(const Name& name, bool positive)
     if (name.value.empty()) {
         TSYM_ERROR("Creating Symbol with empty name, return Undefined instead");
         return Undefined::create();
-    } else if (name.value.find(tmpSymbolNamePrefix) == 0) {
+    } else if (isTemporary(name)) {
         TSYM_ERROR("Instantiation of a non-temporary Symbol containing the temporary name prefix %s,"
                    " return true temporary Symbol",
           name.value);
@@ -62,14 +67,15 @@ tsym::BasePtr tsym::Symbol::create(const Name& name, bool positive)
 
 tsym::BasePtr tsym::Symbol::createNonEmptyName(const Name& name, bool positive)
 {
-    using Key = std::pair<Name, bool>;
-    static std::unordered_map<Key, BasePtr, boost::hash<Key>> pool;
+    auto& pool = Context::current().symbolPool();
     const auto key = std::make_pair(name, positive);
+    const std::lock_guard<std::mutex> lock(pool.mutex);
 
-    if (const auto lookup = pool.find(key); lookup != cend(pool))
+    if (const auto lookup = pool.symbols.find(key); lookup != cend(pool.symbols))
         return lookup->second;
 
-    return pool.insert({key, std::make_shared<const Symbol>(name, positive, Base::CtorKey{})}).first->second;
+    return pool.symbols.insert({key, intern(BasePtr{new const Symbol(name, positive, Base::CtorKey{})})})
+      .first->second;
 }
 
 tsym::BasePtr tsym::Symbol::createPositive(std::string_view name)
@@ -84,9 +90,14 @@ tsym::BasePtr tsym::Symbol::createPositive(const Name& name)
 
 tsym::BasePtr tsym::Symbol::createTmpSymbol(bool positive)
 {
-    ++tmpCounter;
+    const unsigned id = tmpCounter.fetch_add(1, std::memory_order_relaxed) + 1;
 
-    return std::make_shared<const Symbol>(tmpCounter, positive, Base::CtorKey{});
+    return intern(BasePtr{new const Symbol(id, positive, Base::CtorKey{})});
+}
+
+bool tsym::Symbol::isTemporary(const Name& name)
+{
+    return name.value.find(tmpSymbolNamePrefix) == 0;
 }
 
 bool tsym::Symbol::isEqualDifferentBase(const Base& other) const
@@ -105,7 +116,7 @@ bool tsym::Symbol::isEqualOtherSymbol(const Base& other) const
         return false;
 }
 
-std::optional<tsym::Number> tsym::Symbol::numericEval() const
+std::optional<tsym::Number> tsym::Symbol::computeNumericEval() const
 {
     return std::nullopt;
 }
@@ -120,27 +131,17 @@ tsym::BasePtr tsym::Symbol::diffWrtSymbol(const Base& symbol) const
     return isEqual(symbol) ? Numeric::one() : Numeric::zero();
 }
 
-bool tsym::Symbol::isPositive() const
+bool tsym::Symbol::computeIsPositive() const
 {
     return positive;
 }
 
-bool tsym::Symbol::isNegative() const
+bool tsym::Symbol::computeIsNegative() const
 {
     return false;
 }
 
-size_t tsym::Symbol::hash() const
-{
-    size_t seed = 0;
-
-    boost::hash_combine(seed, symbolName);
-    boost::hash_combine(seed, positive);
-
-    return seed;
-}
-
-unsigned tsym::Symbol::complexity() const
+unsigned tsym::Symbol::computeComplexity() const
 {
     return 5;
 }
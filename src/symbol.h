@@ -1,6 +1,7 @@
 #ifndef TSYM_SYMBOL_H
 #define TSYM_SYMBOL_H
 
+#include <atomic>
 #include <string>
 #include <string_view>
 #include "base.h"
@@ -15,6 +16,8 @@ namespace tsym {
         static BasePtr createPositive(std::string_view name);
         static BasePtr createPositive(const Name& name);
         static BasePtr createTmpSymbol(bool positive = false);
+        /* True for names of Symbols created by createTmpSymbol: */
+        static bool isTemporary(const Name& name);
 
         Symbol(Name name, bool positive, Base::CtorKey&&);
         Symbol(unsigned tmpId, bool positive, Base::CtorKey&&);
@@ -22,27 +25,28 @@ namespace tsym {
         Symbol& operator=(const Symbol&) = delete;
         Symbol(Symbol&&) = delete;
         Symbol& operator=(Symbol&&) = delete;
-        ~Symbol() override;
+        ~Symbol() override = default;
 
         bool isEqualDifferentBase(const Base& other) const override;
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap&) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
-        size_t hash() const override;
 
         const Name& name() const override;
 
       private:
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+
         static BasePtr create(const Name& name, bool positive);
         static BasePtr createNonEmptyName(const Name& name, bool positive);
         bool isEqualOtherSymbol(const Base& other) const;
 
         const Name symbolName;
         const bool positive;
-        static unsigned tmpCounter;
+        /* Never decremented, such that concurrently created temporaries can't share an id: */
+        static std::atomic<unsigned> tmpCounter;
         static constexpr std::string_view tmpSymbolNamePrefix = "tmp#";
     };
 }
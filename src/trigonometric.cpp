@@ -14,6 +14,7 @@
 #include "sum.h"
 #include "symbolmap.h"
 #include "undefined.h"
+#include "uniquetable.h"
 
 namespace tsym {
     namespace {
@@ -128,7 +129,7 @@ tsym::BasePtr tsym::Trigonometric::create(Type type, const BasePtr& arg)
 
 tsym::BasePtr tsym::Trigonometric::createInstance(Type type, const BasePtrList& args)
 {
-    return std::make_shared<const Trigonometric>(args, type, Base::CtorKey{});
+    return intern(BasePtr{new const Trigonometric(args, type, Base::CtorKey{})});
 }
 
 bool tsym::Trigonometric::doesSymmetryApply(const BasePtr& arg)
@@ -389,7 +390,7 @@ tsym::BasePtr tsym::Trigonometric::shiftAtanResultIntoRange(BasePtr result, Base
     return result;
 }
 
-std::optional<tsym::Number> tsym::Trigonometric::numericEval() const
+std::optional<tsym::Number> tsym::Trigonometric::computeNumericEval() const
 {
     const auto nArg = arg1->numericEval();
 
@@ -493,13 +494,15 @@ tsym::BasePtr tsym::Trigonometric::subst(const Base& from, const BasePtr& to) co
 {
     if (isEqual(from))
         return to;
+    else if (!mightHave(from))
+        return clone();
     else if (type == Type::ATAN2)
         return createAtan2(arg1->subst(from, to), arg2->subst(from, to));
     else
         return create(type, arg1->subst(from, to));
 }
 
-bool tsym::Trigonometric::isPositive() const
+bool tsym::Trigonometric::computeIsPositive() const
 {
     if (type == Type::ATAN)
         return arg1->isPositive();
@@ -509,7 +512,7 @@ bool tsym::Trigonometric::isPositive() const
     return false;
 }
 
-bool tsym::Trigonometric::isNegative() const
+bool tsym::Trigonometric::computeIsNegative() const
 {
     if (type == Type::ATAN)
         return arg1->isNegative();
@@ -519,7 +522,7 @@ bool tsym::Trigonometric::isNegative() const
     return false;
 }
 
-unsigned tsym::Trigonometric::complexity() const
+unsigned tsym::Trigonometric::computeComplexity() const
 {
     return 6 + complexitySum(ops);
 }
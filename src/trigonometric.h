@@ -31,15 +31,16 @@ namespace tsym {
         Trigonometric& operator=(Trigonometric&&) = delete;
         ~Trigonometric() override = default;
 
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap& map) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
         BasePtr subst(const Base& from, const BasePtr& to) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
 
       private:
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
+
         static BasePtr create(Type type, const BasePtr& arg);
         static BasePtr createInstance(Type type, const BasePtrList& args);
         static bool doesSymmetryApply(const BasePtr& arg);
@@ -2,20 +2,19 @@
 #include "undefined.h"
 #include <cassert>
 #include "basefct.h"
-#include "basetypestr.h"
 #include "fraction.h"
 #include "logging.h"
 #include "numeric.h"
 
 tsym::Undefined::Undefined(Base::CtorKey&&)
-    : Base(typestring::undefined)
+    : Base(Kind::UNDEFINED, 1)
 {
     setDebugString();
 }
 
 const tsym::BasePtr& tsym::Undefined::create()
 {
-    static const BasePtr instance(std::make_shared<const Undefined>(Base::CtorKey{}));
+    static const BasePtr instance{new const Undefined(Base::CtorKey{})};
 
     return instance;
 }
@@ -33,7 +32,7 @@ bool tsym::Undefined::isEqualDifferentBase(const Base& other) const
     return false;
 }
 
-std::optional<tsym::Number> tsym::Undefined::numericEval() const
+std::optional<tsym::Number> tsym::Undefined::computeNumericEval() const
 {
     return std::nullopt;
 }
@@ -48,21 +47,16 @@ tsym::BasePtr tsym::Undefined::diffWrtSymbol(const Base&) const
     return clone();
 }
 
-bool tsym::Undefined::isPositive() const
+bool tsym::Undefined::computeIsPositive() const
 {
     return false;
 }
 
-bool tsym::Undefined::isNegative() const
+bool tsym::Undefined::computeIsNegative() const
 {
     return false;
 }
 
-size_t tsym::Undefined::hash() const
-{
-    return 1;
-}
-
 bool tsym::Undefined::isDifferent(const Base& other) const
 {
     if (isUndefined(other))
@@ -91,7 +85,7 @@ int tsym::Undefined::degree(const Base&) const
     return 0;
 }
 
-unsigned tsym::Undefined::complexity() const
+unsigned tsym::Undefined::computeComplexity() const
 {
     return 0;
 }
@@ -19,19 +19,20 @@ namespace tsym {
         /* Returns always false: */
         bool isEqual(const Base& other) const override;
         bool isEqualDifferentBase(const Base& other) const override;
-        std::optional<Number> numericEval() const override;
         Fraction normal(SymbolMap&) const override;
         BasePtr diffWrtSymbol(const Base& symbol) const override;
-        bool isPositive() const override;
-        bool isNegative() const override;
-        unsigned complexity() const override;
-        size_t hash() const override;
 
         /* Returns always true: */
         bool isDifferent(const Base& other) const override;
         bool has(const Base& other) const override;
         BasePtr subst(const Base& from, const BasePtr& to) const override;
         int degree(const Base& variable) const override;
+
+      private:
+        std::optional<Number> computeNumericEval() const override;
+        bool computeIsPositive() const override;
+        bool computeIsNegative() const override;
+        unsigned computeComplexity() const override;
     };
 }
 
@@ -0,0 +1,65 @@
+
+#include "uniquetable.h"
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include "base.h"
+
+namespace tsym {
+    namespace {
+        struct alignas(64) Stripe {
+            std::mutex mutex;
+            std::unordered_multimap<size_t, const Base*> nodes;
+        };
+
+        /* Nodes are distributed over independently locked stripes by their hash, such that
+         * concurrent construction of unrelated expressions doesn't serialize on a single lock: */
+        using UniqueTable = std::array<Stripe, 32>;
+
+        UniqueTable& table()
+        /* Never destroyed, as nodes referenced by other static objects unregister themselves
+         * during static destruction, too: */
+        {
+            static auto& table = *new UniqueTable();
+
+            return table;
+        }
+
+        Stripe& stripeOf(size_t hash)
+        {
+            auto& stripes = table();
+
+            return stripes[(hash ^ (hash >> 16u)) % stripes.size()];
+        }
+    }
+}
+
+tsym::BasePtr tsym::intern(BasePtr&& node)
+{
+    if (!node->isInterned())
+        return std::move(node);
+
+    const size_t hash = node->hash();
+    auto& [mutex, nodes] = stripeOf(hash);
+    const std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto [it, last] = nodes.equal_range(hash); it != last; ++it)
+        if (it->second->isEqualDifferentBase(*node) && tryAddRef(it->second))
+            return BasePtr{it->second, false};
+
+    nodes.emplace(hash, node.get());
+
+    return std::move(node);
+}
+
+void tsym::unintern(const Base& node)
+{
+    auto& [mutex, nodes] = stripeOf(node.hash());
+    const std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto [it, last] = nodes.equal_range(node.hash()); it != last; ++it)
+        if (it->second == &node) {
+            nodes.erase(it);
+            return;
+        }
+}
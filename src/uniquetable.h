@@ -0,0 +1,23 @@
+#ifndef TSYM_UNIQUETABLE_H
+#define TSYM_UNIQUETABLE_H
+
+#include "baseptr.h"
+
+namespace tsym {
+    /* Hash consing of expression nodes. Every Base subclass instance is passed through this function
+     * right after construction, such that there is at most one alive instance for every
+     * structurally distinct expression. If an equal node already exists, it is returned and the
+     * argument is discarded, otherwise, the argument is registered and returned. This turns
+     * equality checks of interned nodes into pointer comparisons and lets equal subtrees share a
+     * single allocation. The table only holds raw pointers, i.e., it doesn't extend the lifetime
+     * of any node. Nodes that can't be compared by identity (see Base::isInterned) are returned
+     * unchanged. The table is split into stripes guarded by a mutex each, and a node whose
+     * reference count already dropped to zero is never handed out again, even if it is still
+     * registered. */
+    BasePtr intern(BasePtr&& node);
+
+    /* Removes the given node from the table, to be called when the last reference to it is released: */
+    void unintern(const Base& node);
+}
+
+#endif
@@ -1,9 +1,10 @@
 
 #include "var.h"
-#include <map>
+#include <mutex>
 #include <stdexcept>
 #include "base.h"
 #include "basefct.h"
+#include "context.h"
 #include "logging.h"
 #include "numberfct.h"
 #include "numeric.h"
@@ -16,18 +17,18 @@
 #include "symbol.h"
 #include "undefined.h"
 
+struct tsym::Var::Chain {
+    Operation operation = Operation::SUM;
+    /* Current upon creation of the chain, its options and caches are used for the simplification: */
+    Context* context = nullptr;
+    BasePtrList operands{};
+    BasePtr result{};
+    std::once_flag simplification{};
+    bool simplified = false;
+};
+
 namespace tsym {
     namespace {
-        const std::map<std::string_view, Var::Type>& typeStringMap()
-        {
-            static const std::map<std::string_view, Var::Type> map{{"Sum", Var::Type::SUM},
-              {"Product", Var::Type::PRODUCT}, {"Symbol", Var::Type::SYMBOL}, {"Power", Var::Type::POWER},
-              {"Constant", Var::Type::CONSTANT}, {"Undefined", Var::Type::UNDEFINED}, {"Function", Var::Type::FUNCTION},
-              {"Integer", Var::Type::INT}, {"Fraction", Var::Type::FRACTION}, {"Double", Var::Type::DOUBLE}};
-
-            return map;
-        }
-
         bool isCorrectIntOrSymbol(const ParseResult& parsed)
         {
             const bool parsingSuccess = parsed.success && parsed.matchedWholeString;
@@ -112,29 +113,94 @@ tsym::Var::Var(BasePtr ptr)
 {}
 
 tsym::Var& tsym::Var::operator+=(const Var& rhs)
+/* The own handle can't be moved into the new sum if it's also the right hand side: */
 {
-    rep = Sum::create(rep, rhs.rep);
+    if (&rhs == this)
+        rep = Sum::create(get(), get());
+    else
+        rep = Sum::create(std::move(*this).get(), rhs.get());
+
+    chain.reset();
 
     return *this;
 }
 
 tsym::Var& tsym::Var::operator-=(const Var& rhs)
 {
-    rep = Sum::create(rep, Product::minus(rhs.rep));
+    BasePtr negated = Product::minus(rhs.get());
+
+    rep = Sum::create(std::move(*this).get(), std::move(negated));
+    chain.reset();
 
     return *this;
 }
 
 tsym::Var& tsym::Var::operator*=(const Var& rhs)
 {
-    rep = Product::create(rep, rhs.rep);
+    if (&rhs == this)
+        rep = Product::create(get(), get());
+    else
+        rep = Product::create(std::move(*this).get(), rhs.get());
+
+    chain.reset();
 
     return *this;
 }
 
 tsym::Var& tsym::Var::operator/=(const Var& rhs)
 {
-    rep = Product::create(rep, Power::oneOver(rhs.rep));
+    BasePtr inverse = Power::oneOver(rhs.get());
+
+    rep = Product::create(std::move(*this).get(), std::move(inverse));
+    chain.reset();
+
+    return *this;
+}
+
+tsym::Var& tsym::Var::operator+=(Var&& rhs)
+{
+    if (&rhs == this)
+        return *this += static_cast<const Var&>(rhs);
+
+    rep = Sum::create(std::move(*this).get(), std::move(rhs).get());
+    chain.reset();
+
+    return *this;
+}
+
+tsym::Var& tsym::Var::operator-=(Var&& rhs)
+{
+    if (&rhs == this)
+        return *this -= static_cast<const Var&>(rhs);
+
+    BasePtr negated = Product::minus(std::move(rhs).get());
+
+    rep = Sum::create(std::move(*this).get(), std::move(negated));
+    chain.reset();
+
+    return *this;
+}
+
+tsym::Var& tsym::Var::operator*=(Var&& rhs)
+{
+    if (&rhs == this)
+        return *this *= static_cast<const Var&>(rhs);
+
+    rep = Product::create(std::move(*this).get(), std::move(rhs).get());
+    chain.reset();
+
+    return *this;
+}
+
+tsym::Var& tsym::Var::operator/=(Var&& rhs)
+{
+    if (&rhs == this)
+        return *this /= static_cast<const Var&>(rhs);
+
+    BasePtr inverse = Power::oneOver(std::move(rhs).get());
+
+    rep = Product::create(std::move(*this).get(), std::move(inverse));
+    chain.reset();
 
     return *this;
 }
@@ -146,33 +212,48 @@ const tsym::Var& tsym::Var::operator+() const
 
 tsym::Var tsym::Var::operator-() const
 {
-    return Var(Product::minus(rep));
+    return Var(Product::minus(get()));
 }
 
 tsym::Var::Type tsym::Var::type() const
 {
-    if (isNumeric(*rep))
-        return numericType(*rep->numericEval());
-
-    const auto lookup = typeStringMap().find(rep->typeStr());
-
-    assert(lookup != cend(typeStringMap()));
+    const BasePtr& value = get();
+
+    switch (value->kind()) {
+        case Base::Kind::NUMERIC:
+            return numericType(*value->numericEval());
+        case Base::Kind::CONSTANT:
+            return Type::CONSTANT;
+        case Base::Kind::SYMBOL:
+            return Type::SYMBOL;
+        case Base::Kind::UNDEFINED:
+            return Type::UNDEFINED;
+        case Base::Kind::FUNCTION:
+            return Type::FUNCTION;
+        case Base::Kind::POWER:
+            return Type::POWER;
+        case Base::Kind::PRODUCT:
+            return Type::PRODUCT;
+        case Base::Kind::SUM:
+            return Type::SUM;
+    }
 
-    return lookup->second;
+    return Type::UNDEFINED;
 }
 
 tsym::Var::operator int() const
 {
     static const char* errorMessage = "Illegal integer request";
+    const BasePtr& value = get();
     int result = 0;
 
-    if (!isInteger(*rep))
+    if (!isInteger(*value))
         throw std::domain_error(errorMessage);
-    else if (!fitsInto<int>(rep->numericEval()->numerator()))
+    else if (!fitsInto<int>(value->numericEval()->numerator()))
         throw std::overflow_error(errorMessage);
 
     try {
-        result = static_cast<int>(rep->numericEval().value().numerator());
+        result = static_cast<int>(value->numericEval().value().numerator());
     } catch (const std::exception& e) {
         TSYM_ERROR("Conversion from %S to int failed: %s", *this, e.what());
         throw std::domain_error(errorMessage);
@@ -183,15 +264,69 @@ tsym::Var::operator int() const
 
 tsym::Var::operator double() const
 {
-    if (const auto num = rep->numericEval())
+    if (const auto num = get()->numericEval())
         return num->toDouble();
 
     throw std::domain_error("Illegal conversion to double requested");
 }
 
-const tsym::BasePtr& tsym::Var::get() const
+const tsym::BasePtr& tsym::Var::get() const&
+{
+    return chain ? evaluate(*chain) : rep;
+}
+
+tsym::BasePtr tsym::Var::get() &&
 {
-    return rep;
+    if (!chain)
+        return std::move(rep);
+
+    evaluate(*chain);
+
+    BasePtr result = chain.use_count() == 1 ? std::move(chain->result) : chain->result;
+
+    chain.reset();
+
+    return result;
+}
+
+void tsym::Var::append(Operation operation, BasePtr operand)
+/* The chain is extended in place as long as no other instance shares it. Otherwise, for a
+ * different operation or context, the current value becomes the first operand of a new chain: */
+{
+    Context& context = Context::current();
+
+    if (chain && chain->operation == operation && chain->context == &context && !chain->simplified
+      && chain.use_count() == 1) {
+        chain->operands.push_back(std::move(operand));
+        return;
+    }
+
+    auto next = std::make_shared<Chain>();
+
+    next->operation = operation;
+    next->context = &context;
+    next->operands = makeList(std::move(*this).get(), std::move(operand));
+
+    chain = std::move(next);
+}
+
+const tsym::BasePtr& tsym::Var::evaluate(Chain& chain)
+/* Copies share the chain and hence the result, which is computed only once, in the context the
+ * chain was created in, no matter which one is current now. The operands aren't needed afterwards: */
+{
+    std::call_once(chain.simplification, [&chain]() {
+        const Context::Selection selection(*chain.context);
+
+        if (chain.operation == Operation::SUM)
+            chain.result = Sum::createLikeStepwise(chain.operands);
+        else
+            chain.result = Product::createLikeStepwise(chain.operands);
+
+        chain.operands.clear();
+        chain.simplified = true;
+    });
+
+    return chain.result;
 }
 
 bool tsym::operator==(const Var& lhs, const Var& rhs)
@@ -206,28 +341,56 @@ bool tsym::operator!=(const Var& lhs, const Var& rhs)
 
 tsym::Var tsym::operator+(Var lhs, const Var& rhs)
 {
-    lhs += rhs;
+    lhs.append(Var::Operation::SUM, rhs.get());
 
     return lhs;
 }
 
 tsym::Var tsym::operator-(Var lhs, const Var& rhs)
 {
-    lhs -= rhs;
+    lhs.append(Var::Operation::SUM, Product::minus(rhs.get()));
 
     return lhs;
 }
 
 tsym::Var tsym::operator*(Var lhs, const Var& rhs)
 {
-    lhs *= rhs;
+    lhs.append(Var::Operation::PRODUCT, rhs.get());
 
     return lhs;
 }
 
 tsym::Var tsym::operator/(Var lhs, const Var& rhs)
 {
-    lhs /= rhs;
+    lhs.append(Var::Operation::PRODUCT, Power::oneOver(rhs.get()));
+
+    return lhs;
+}
+
+tsym::Var tsym::operator+(Var lhs, Var&& rhs)
+{
+    lhs.append(Var::Operation::SUM, std::move(rhs).get());
+
+    return lhs;
+}
+
+tsym::Var tsym::operator-(Var lhs, Var&& rhs)
+{
+    lhs.append(Var::Operation::SUM, Product::minus(std::move(rhs).get()));
+
+    return lhs;
+}
+
+tsym::Var tsym::operator*(Var lhs, Var&& rhs)
+{
+    lhs.append(Var::Operation::PRODUCT, std::move(rhs).get());
+
+    return lhs;
+}
+
+tsym::Var tsym::operator/(Var lhs, Var&& rhs)
+{
+    lhs.append(Var::Operation::PRODUCT, Power::oneOver(std::move(rhs).get()));
 
     return lhs;
 }
@@ -243,9 +406,28 @@ std::ostream& tsym::operator<<(std::ostream& stream, const Var& rhs)
 
 std::ostream& tsym::operator<<(std::ostream& stream, const Var::Type& rhs)
 {
-    for (const auto& [str, type] : typeStringMap())
-        if (type == rhs)
-            return stream << str;
+    switch (rhs) {
+        case Var::Type::SYMBOL:
+            return stream << "Symbol";
+        case Var::Type::INT:
+            return stream << "Integer";
+        case Var::Type::FRACTION:
+            return stream << "Fraction";
+        case Var::Type::DOUBLE:
+            return stream << "Double";
+        case Var::Type::CONSTANT:
+            return stream << "Constant";
+        case Var::Type::UNDEFINED:
+            return stream << "Undefined";
+        case Var::Type::FUNCTION:
+            return stream << "Function";
+        case Var::Type::SUM:
+            return stream << "Sum";
+        case Var::Type::PRODUCT:
+            return stream << "Product";
+        case Var::Type::POWER:
+            return stream << "Power";
+    }
 
     TSYM_ERROR("Couldn't find string representation of Var");
 
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "cache.h"
+#include "tsym.h"
+
+/* Measures the simplification throughput of several threads that share the registered caches
+ * and the unique table. Every thread works through the same expressions, such that the caches
+ * are hit concurrently. Thread counts are passed as arguments and default to 1, 8 and 32. This
+ * isn't part of the unit tests, as the numbers only make sense on a machine with as many cores as
+ * threads. */
+
+namespace {
+    constexpr int expressionsPerThread = 200;
+    constexpr int distinctExpressions = 100;
+
+    void work()
+    {
+        const tsym::Var a("a");
+        const tsym::Var b("b");
+        const tsym::Var c("c");
+
+        for (int i = 0; i < expressionsPerThread; ++i) {
+            const tsym::Var n(i % distinctExpressions + 2);
+            const tsym::Var expr = (a + n * b) / (a * a - n * n * b * b) + tsym::sin(n * c) * tsym::pow(a + c, 3);
+
+            tsym::simplify(tsym::expand(expr));
+        }
+    }
+
+    double expressionsPerSecond(int nThreads)
+    {
+        std::vector<std::thread> threads;
+
+        tsym::clearRegisteredCaches();
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < nThreads; ++i)
+            threads.emplace_back(work);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return nThreads * expressionsPerThread / elapsed.count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<int> threadCounts{1, 8, 32};
+
+    if (argc > 1) {
+        threadCounts.clear();
+
+        for (int i = 1; i < argc; ++i)
+            threadCounts.push_back(std::atoi(argv[i]));
+    }
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    for (const int nThreads : threadCounts)
+        std::cout << nThreads << " threads: " << expressionsPerSecond(nThreads) << " expressions/s" << std::endl;
+
+    return 0;
+}
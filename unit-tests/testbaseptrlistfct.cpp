@@ -17,12 +17,14 @@ BOOST_AUTO_TEST_CASE(restOfEmptyList, noLogs())
     BOOST_TEST(result.empty());
 }
 
-BOOST_AUTO_TEST_CASE(restOfRvalueArg)
+BOOST_AUTO_TEST_CASE(restOfList)
 {
     const BasePtrList expected{b, c, d, ten};
-    const BasePtrList list = rest({a, b, c, d, ten});
+    const BasePtrList list{a, b, c, d, ten};
+    const BasePtrListView view = rest(list);
+    const BasePtrList result(std::cbegin(view), std::cend(view));
 
-    BOOST_TEST(expected == list, per_element());
+    BOOST_TEST(expected == result, per_element());
 }
 
 BOOST_AUTO_TEST_SUITE_END()
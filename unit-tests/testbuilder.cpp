@@ -0,0 +1,184 @@
+#include "builder.h"
+#include "functions.h"
+#include "tsymtests.h"
+#include "var.h"
+
+using namespace tsym;
+
+struct BuilderFixture {
+    const Var a = Var("a");
+    const Var b = Var("b");
+    const Var c = Var("c");
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestBuilder, BuilderFixture)
+
+BOOST_AUTO_TEST_CASE(emptySum)
+{
+    const SumBuilder sum;
+
+    BOOST_CHECK_EQUAL(0, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(emptyProduct)
+{
+    const ProductBuilder product;
+
+    BOOST_CHECK_EQUAL(1, product.get());
+}
+
+BOOST_AUTO_TEST_CASE(singleSummand)
+{
+    SumBuilder sum;
+
+    sum += a;
+
+    BOOST_CHECK_EQUAL(1, sum.size());
+    BOOST_CHECK_EQUAL(a, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(sumEqualToRepeatedAddition)
+{
+    SumBuilder sum;
+    Var expected;
+
+    for (int i = 0; i < 100; ++i) {
+        const Var summand = Var(i % 7 - 3, i % 4 + 1) * pow(a, i % 3) * pow(b, i % 5);
+
+        sum += summand;
+        expected += summand;
+    }
+
+    sum -= a * b;
+    expected -= a * b;
+
+    BOOST_CHECK_EQUAL(101, sum.size());
+    BOOST_CHECK_EQUAL(expected, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(sumWithCancellingSummands)
+{
+    SumBuilder sum;
+
+    for (const auto& summand : {a, b, c, sin(a), a * b})
+        sum += summand;
+
+    for (const auto& summand : {a, b, c, sin(a), a * b})
+        sum -= summand;
+
+    BOOST_CHECK_EQUAL(0, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(nonCollectableSumEqualToRepeatedAddition)
+/* Irrational coefficients and squares of trigonometric functions are simplified depending on the
+ * order of the summands: */
+{
+    SumBuilder sum;
+    Var expected;
+
+    for (const auto& summand : {sqrt(2) * a, b, sqrt(3) * a, pow(sin(b), 2), a * sqrt(2), pow(cos(b), 2)}) {
+        sum += summand;
+        expected += summand;
+    }
+
+    sum += 2 * pow(cos(b), 2);
+    expected += 2 * pow(cos(b), 2);
+
+    BOOST_CHECK_EQUAL(expected, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(productEqualToRepeatedMultiplication)
+{
+    ProductBuilder product;
+    Var expected(1);
+
+    for (int i = 0; i < 50; ++i) {
+        const Var factor = i % 4 == 0 ? Var(i + 1) : pow(i % 2 == 0 ? a : b + c, i % 3 + 1);
+
+        product *= factor;
+        expected *= factor;
+    }
+
+    product /= b + c;
+    expected /= b + c;
+
+    BOOST_CHECK_EQUAL(expected, product.get());
+}
+
+BOOST_AUTO_TEST_CASE(nonCollectableProductEqualToRepeatedMultiplication)
+/* Numeric powers are contracted depending on the order of the factors: */
+{
+    ProductBuilder product;
+    Var expected(1);
+
+    for (int i = 0; i < 12; ++i) {
+        const Var factor = pow(i % 5 + 2, Var(1, i % 3 + 2));
+
+        product *= factor;
+        expected *= factor;
+    }
+
+    for (const auto& factor : {sqrt(Var(3)), sqrt(Var(17)), pow(17, Var(2, 3)), sqrt(Var(2))}) {
+        product *= factor;
+        expected *= factor;
+    }
+
+    BOOST_CHECK_EQUAL(expected, product.get());
+}
+
+BOOST_AUTO_TEST_CASE(repeatedSummandsCombinedWhileAccumulating)
+/* Enough summands for like terms to be combined before the result is requested, followed by
+ * summands that must be added in order: */
+{
+    SumBuilder sum;
+    Var expected;
+
+    for (int i = 0; i < 500; ++i) {
+        const Var summand = Var(i % 5 - 2, i % 3 + 1) * pow(a, i % 3) * b;
+
+        sum += summand;
+        expected += summand;
+    }
+
+    for (const auto& summand : {sqrt(2) * a * b, pow(sin(a), 2), a * b, pow(cos(a), 2)}) {
+        sum += summand;
+        expected += summand;
+    }
+
+    BOOST_CHECK_EQUAL(504, sum.size());
+    BOOST_CHECK_EQUAL(expected, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(repeatedFactorsCombinedWhileAccumulating)
+{
+    ProductBuilder product;
+    Var expected(1);
+
+    for (int i = 0; i < 300; ++i) {
+        const Var factor = i % 7 == 0 ? Var(i % 3 + 1, 2) : pow(i % 2 == 0 ? a : b + c, i % 3 - 1);
+
+        product *= factor;
+        expected *= factor;
+    }
+
+    for (const auto& factor : {sqrt(Var(2)), b + c, sqrt(Var(8)), pow(a, Var(1, 2))}) {
+        product *= factor;
+        expected *= factor;
+    }
+
+    BOOST_CHECK_EQUAL(304, product.size());
+    BOOST_CHECK_EQUAL(expected, product.get());
+}
+
+BOOST_AUTO_TEST_CASE(productWithZeroFactor)
+{
+    ProductBuilder product;
+
+    product *= a;
+    product *= 0;
+    product *= b;
+
+    BOOST_CHECK_EQUAL(0, product.get());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
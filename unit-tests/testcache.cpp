@@ -0,0 +1,487 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "cache.h"
+#include "fixtures.h"
+#include "functions.h"
+#include "sum.h"
+#include "symbol.h"
+#include "var.h"
+#include "tsymtests.h"
+
+using namespace tsym;
+
+namespace {
+    RegisteredCache<int, int>& perThreadCache()
+    {
+        TSYM_CACHE_STORAGE RegisteredCache<int, int> cache("perThread");
+
+        return cache;
+    }
+}
+
+struct CacheFixture {
+    /* A single shard, such that the eviction order is exact: */
+    RegisteredCache<int, int> cache{"test", 1};
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestCache, CacheFixture)
+
+BOOST_AUTO_TEST_CASE(lookupOfInsertedValue)
+{
+    BOOST_CHECK_EQUAL(20, cache.insert(2, 20));
+
+    const auto lookup = cache.find(2);
+
+    BOOST_TEST_REQUIRE(lookup.has_value());
+    BOOST_CHECK_EQUAL(20, *lookup);
+    BOOST_TEST(!cache.find(3).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(leastRecentlyUsedEntryEvicted)
+{
+    cache.setCapacity(2);
+
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.find(1);
+    cache.insert(3, 30);
+
+    BOOST_TEST(cache.find(1).has_value());
+    BOOST_TEST(!cache.find(2).has_value());
+    BOOST_TEST(cache.find(3).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(zeroCapacityDisablesCaching)
+{
+    cache.insert(1, 10);
+
+    BOOST_TEST(setRegisteredCacheCapacity("test", 0));
+
+    BOOST_TEST(!cache.find(1).has_value());
+    BOOST_CHECK_EQUAL(20, cache.insert(2, 20));
+    BOOST_TEST(!cache.find(2).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(clearViaRegistry)
+{
+    cache.insert(1, 10);
+
+    clearRegisteredCaches();
+
+    BOOST_TEST(!cache.find(1).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(clearOfAllThreads)
+{
+    cache.insert(1, 10);
+
+    clearRegisteredCachesOfAllThreads();
+
+    BOOST_TEST(!cache.find(1).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(unknownCacheName)
+{
+    BOOST_TEST(!setRegisteredCacheCapacity("nonExisting", 10));
+}
+
+BOOST_AUTO_TEST_CASE(countersOfLookupAndInsertion)
+{
+    cache.setCapacity(1);
+
+    cache.find(1);
+    cache.insert(1, 10);
+    cache.find(1);
+    cache.insert(2, 20);
+
+    const CacheStats stats = cache.stats();
+
+    BOOST_CHECK_EQUAL("test", stats.name);
+    BOOST_CHECK_EQUAL(1, stats.hits);
+    BOOST_CHECK_EQUAL(1, stats.misses);
+    BOOST_CHECK_EQUAL(2, stats.insertions);
+    BOOST_CHECK_EQUAL(1, stats.evictions);
+    BOOST_CHECK_EQUAL(1, stats.entries);
+    BOOST_CHECK_EQUAL(1, stats.capacity);
+}
+
+BOOST_AUTO_TEST_CASE(footprintGrowsWithEntries)
+{
+    const std::size_t emptySize = cache.stats().approxBytes;
+
+    for (int i = 0; i < 100; ++i)
+        cache.insert(i, i);
+
+    BOOST_TEST(cache.stats().approxBytes > emptySize);
+}
+
+BOOST_AUTO_TEST_CASE(statsViaRegistry)
+{
+    cache.insert(1, 10);
+
+    const auto all = registeredCacheStats();
+    const auto lookup =
+      std::find_if(cbegin(all), cend(all), [](const CacheStats& stats) { return stats.name == "test"; });
+
+    BOOST_TEST_REQUIRE((lookup != cend(all)));
+    BOOST_CHECK_EQUAL(1, lookup->entries);
+}
+
+BOOST_AUTO_TEST_CASE(capacitySplitAcrossShards)
+{
+    RegisteredCache<int, int> sharded{"sharded", 4};
+
+    sharded.setCapacity(8);
+
+    for (int i = 0; i < 100; ++i)
+        sharded.insert(i, i);
+
+    const CacheStats stats = sharded.stats();
+
+    BOOST_TEST(stats.entries > 0);
+    BOOST_TEST(stats.entries <= 8);
+    BOOST_CHECK_EQUAL(100, stats.insertions);
+    BOOST_CHECK_EQUAL(100 - stats.entries, stats.evictions);
+}
+
+BOOST_AUTO_TEST_CASE(capacitySmallerThanShardCount)
+{
+    RegisteredCache<int, int> sharded{"sharded"};
+
+    sharded.setCapacity(5);
+
+    for (int i = 0; i < 1000; ++i)
+        sharded.insert(i, i);
+
+    const CacheStats stats = sharded.stats();
+
+    BOOST_TEST(stats.entries > 0);
+    BOOST_TEST(stats.entries <= 5);
+    BOOST_CHECK_EQUAL(5, stats.capacity);
+}
+
+BOOST_AUTO_TEST_CASE(concurrentInsertionAndLookup, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    RegisteredCache<int, int> sharded{"sharded"};
+    std::vector<std::thread> threads;
+
+    for (int offset = 0; offset < 8; ++offset)
+        threads.emplace_back([&sharded, offset]() {
+            for (int i = 0; i < 1000; ++i) {
+                const int key = 1000 * offset + i;
+                sharded.insert(key, -key);
+                sharded.find(key);
+            }
+        });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    const CacheStats stats = sharded.stats();
+
+    BOOST_CHECK_EQUAL(8000, stats.entries);
+    BOOST_CHECK_EQUAL(8000, stats.hits);
+    BOOST_CHECK_EQUAL(-4711, sharded.find(4711).value_or(0));
+}
+
+BOOST_AUTO_TEST_CASE(clearFromOtherThread)
+{
+    bool foundByOtherThread = false;
+
+    perThreadCache().insert(1, 10);
+
+    std::thread([&foundByOtherThread]() {
+        foundByOtherThread = perThreadCache().find(1).has_value();
+        clearRegisteredCachesOfAllThreads();
+    }).join();
+
+    BOOST_CHECK_EQUAL(!detail::threadLocalCaches, foundByOtherThread);
+    BOOST_TEST(!perThreadCache().find(1).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(scopedEntriesDroppedWithScope)
+{
+    {
+        const CacheScope scope;
+
+        cache.insert(1, 10);
+
+        BOOST_CHECK_EQUAL(10, cache.find(1).value_or(0));
+    }
+
+    BOOST_TEST(!cache.find(1).has_value());
+    BOOST_CHECK_EQUAL(0, cache.stats().insertions);
+}
+
+BOOST_AUTO_TEST_CASE(sharedEntriesVisibleInScope)
+{
+    cache.insert(1, 10);
+
+    const CacheScope scope;
+
+    BOOST_CHECK_EQUAL(10, cache.find(1).value_or(0));
+}
+
+BOOST_AUTO_TEST_CASE(nestedScopes)
+{
+    const CacheScope outer;
+
+    cache.insert(1, 10);
+
+    {
+        const CacheScope inner;
+
+        cache.insert(2, 20);
+
+        BOOST_CHECK_EQUAL(10, cache.find(1).value_or(0));
+        BOOST_CHECK_EQUAL(20, cache.find(2).value_or(0));
+    }
+
+    BOOST_CHECK_EQUAL(10, cache.find(1).value_or(0));
+    BOOST_TEST(!cache.find(2).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(scopeOnlyAffectsConstructingThread)
+{
+    RegisteredCache<int, int> shared{"sharedAcrossThreads"};
+    const CacheScope scope;
+
+    std::thread([&shared]() { shared.insert(1, 10); }).join();
+
+    BOOST_CHECK_EQUAL(1, shared.stats().entries);
+}
+
+BOOST_AUTO_TEST_CASE(persistedEntriesLoadedOnMiss)
+{
+    RegisteredCache<BasePtr, BasePtr> exprCache{"persistedExpressions"};
+    const BasePtr key = Sum::create(Symbol::create("a"), Symbol::create("b"));
+    const BasePtr value = Symbol::create("c");
+    const std::string path = (std::filesystem::temp_directory_path() / "tsym-testcache.bin").string();
+
+    exprCache.insert(key, value);
+
+    BOOST_TEST_REQUIRE(saveRegisteredCaches(path));
+    BOOST_TEST(!std::filesystem::exists(path + ".tmp"));
+
+    exprCache.clear();
+
+    BOOST_TEST(!exprCache.find(key).has_value());
+    BOOST_TEST_REQUIRE(loadRegisteredCaches(path));
+    BOOST_CHECK_EQUAL(value, exprCache.find(key).value_or(nullptr));
+    BOOST_CHECK_EQUAL(1, exprCache.stats().persistedHits);
+
+    discardPersistedCacheEntries();
+    std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(normalizationRestoredFromFile)
+{
+    const Var a("a");
+    const Var b("b");
+    const Var expr = a / b + 1 / (a + b);
+    const Var expected = simplify(expr);
+    const std::string path = (std::filesystem::temp_directory_path() / "tsym-testcache-normal.bin").string();
+    const auto persistedHitsOfNormal = []() {
+        const auto all = registeredCacheStats();
+        const auto lookup =
+          std::find_if(cbegin(all), cend(all), [](const CacheStats& stats) { return stats.name == "normal"; });
+
+        return lookup == cend(all) ? 0 : lookup->persistedHits;
+    };
+
+    BOOST_TEST_REQUIRE(saveRegisteredCaches(path));
+    clearRegisteredCaches();
+    BOOST_TEST_REQUIRE(loadRegisteredCaches(path));
+
+    const std::size_t before = persistedHitsOfNormal();
+
+    BOOST_CHECK_EQUAL(expected, simplify(expr));
+    BOOST_TEST(persistedHitsOfNormal() > before);
+
+    discardPersistedCacheEntries();
+    std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(foreignFileRejected, noLogs())
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "tsym-testcache-foreign.bin").string();
+
+    std::ofstream(path) << "not a cache file";
+
+    BOOST_TEST(!loadRegisteredCaches(path));
+    BOOST_TEST(!loadRegisteredCaches(path + ".nonExisting"));
+
+    std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(existingFileReplacedOnSave)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "tsym-testcache-replaced.bin").string();
+
+    std::ofstream(path) << "not a cache file";
+
+    BOOST_TEST_REQUIRE(saveRegisteredCaches(path));
+    BOOST_TEST(!std::filesystem::exists(path + ".tmp"));
+    BOOST_TEST(loadRegisteredCaches(path));
+
+    discardPersistedCacheEntries();
+    std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(failingSaveLeavesNoFile, noLogs())
+{
+    const auto dir = std::filesystem::temp_directory_path() / "tsym-testcache-nonExisting";
+    const std::string path = (dir / "cache.bin").string();
+
+    BOOST_TEST(!saveRegisteredCaches(path));
+    BOOST_TEST(!std::filesystem::exists(dir));
+}
+
+
+BOOST_AUTO_TEST_CASE(listLookupWithoutKeyCopy)
+{
+    RegisteredCache<BasePtrList, BasePtr, ListHash, ListEqualTo> lists{"lists"};
+    const BasePtr a = Symbol::create("a");
+    const BasePtr b = Symbol::create("b");
+    const BasePtrList key{a, b};
+
+    BOOST_CHECK_EQUAL(ListHash{}(key), ListHash{}(ListLookup(a, b)));
+    BOOST_CHECK_EQUAL(ListHash{}(key), ListHash{}(ListLookup(key)));
+
+    lists.insert(key, a);
+
+    BOOST_CHECK_EQUAL(a, lists.find(ListLookup(a, b)).value_or(nullptr));
+    BOOST_CHECK_EQUAL(a, lists.find(ListLookup(key)).value_or(nullptr));
+    BOOST_TEST(!lists.find(ListLookup(b, a)).has_value());
+    BOOST_TEST(!lists.find(ListLookup(BasePtrList{a, b, a})).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(weakEntryPurgedWithKey, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    /* Symbols that no other test uses, such that no other cache holds expressions of them: */
+    RegisteredCache<BasePtr, BasePtr> weak{"weak"};
+    const BasePtr value = Symbol::create("weakC");
+
+    weak.setWeak(true);
+
+    {
+        const BasePtr key = Sum::create(Symbol::create("weakA"), Symbol::create("weakB"));
+
+        weak.insert(key, value);
+
+        BOOST_CHECK_EQUAL(value, weak.find(key).value_or(nullptr));
+        BOOST_CHECK_EQUAL(1, weak.stats().entries);
+    }
+
+    BOOST_CHECK_EQUAL(0, weak.stats().entries);
+}
+
+BOOST_AUTO_TEST_CASE(weakEntryPurgedWithValue, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    RegisteredCache<BasePtr, BasePtr> weak{"weak"};
+    const BasePtr key = Symbol::create("weakA");
+
+    weak.setWeak(true);
+    weak.insert(key, Sum::create(key, Symbol::create("weakB")));
+
+    BOOST_TEST(!weak.find(key).has_value());
+    BOOST_CHECK_EQUAL(0, weak.stats().entries);
+}
+
+BOOST_AUTO_TEST_CASE(weakEntryDoesntKeepItselfAlive, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    RegisteredCache<BasePtrList, BasePtr> weak{"weak"};
+    BasePtr sum = Sum::create(Symbol::create("weakA"), Symbol::create("weakB"));
+
+    weak.setWeak(true);
+    weak.insert({sum, sum}, sum);
+    sum.reset();
+
+    BOOST_CHECK_EQUAL(0, weak.stats().entries);
+}
+
+BOOST_AUTO_TEST_CASE(weakEntryWithTemporaryKeyPurged, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    RegisteredCache<BasePtrList, BasePtr> weak{"weak"};
+    const BasePtr value = Symbol::create("weakC");
+    BasePtrList key;
+
+    weak.setWeak(true);
+    /* The key node isn't owned by anyone else and must be destroyed, which purges the entry: */
+    key.push_back(Sum::create(Symbol::create("weakA"), Symbol::create("weakB")));
+    weak.insert(std::move(key), value);
+
+    BOOST_CHECK_EQUAL(0, weak.stats().entries);
+}
+
+BOOST_AUTO_TEST_CASE(weakEntryReinsertedWithLastKeyHandle, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    RegisteredCache<BasePtrList, BasePtr> weak{"weak"};
+    const BasePtr value = Symbol::create("weakC");
+    BasePtr key = Sum::create(Symbol::create("weakA"), Symbol::create("weakB"));
+    BasePtrList keyList;
+
+    weak.setWeak(true);
+    weak.insert(BasePtrList{key}, value);
+
+    BOOST_CHECK_EQUAL(1, weak.stats().entries);
+
+    /* The unused key of the second insertion holds the last reference, and its destruction
+     * purges the existing entry: */
+    keyList.push_back(std::move(key));
+    weak.insert(std::move(keyList), value);
+
+    BOOST_CHECK_EQUAL(0, weak.stats().entries);
+}
+
+BOOST_AUTO_TEST_CASE(switchingToWeakEntriesClears, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    RegisteredCache<BasePtr, BasePtr> exprCache{"weak"};
+    const BasePtr key = Symbol::create("a");
+
+    exprCache.insert(key, key);
+    exprCache.setWeak(true);
+
+    BOOST_TEST(!exprCache.find(key).has_value());
+
+    exprCache.insert(key, key);
+
+    BOOST_CHECK_EQUAL(key, exprCache.find(key).value_or(nullptr));
+}
+
+BOOST_AUTO_TEST_CASE(concurrentSimplificationWithWeakCaches,
+  *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    std::vector<std::thread> threads;
+    /* Not std::vector<bool>, whose packed elements can't be written concurrently: */
+    std::array<bool, 8> correct{};
+
+    BOOST_TEST_REQUIRE(setWeakRegisteredCaches(true));
+
+    for (std::size_t i = 0; i < correct.size(); ++i)
+        threads.emplace_back([&correct, i]() {
+            const Var a("a");
+            const Var b("b");
+            bool result = true;
+
+            for (int n = 0; n < 100; ++n)
+                result = result && simplify((a + n) * (b - n) / (a + n)) == b - n;
+
+            correct[i] = result;
+        });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    setWeakRegisteredCaches(false);
+
+    for (const bool threadResult : correct)
+        BOOST_TEST(threadResult);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
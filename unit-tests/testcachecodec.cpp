@@ -0,0 +1,168 @@
+
+#include <limits>
+#include "basefct.h"
+#include "cachecodec.h"
+#include "constant.h"
+#include "fixtures.h"
+#include "logarithm.h"
+#include "numeric.h"
+#include "power.h"
+#include "product.h"
+#include "sum.h"
+#include "symbol.h"
+#include "trigonometric.h"
+#include "tsymtests.h"
+
+using namespace tsym;
+
+struct CacheCodecFixture : public AbcFixture {
+    BasePtr roundTrip(const BasePtr& expr)
+    {
+        std::string bytes;
+
+        BOOST_TEST_REQUIRE(encode(*expr, bytes));
+
+        std::string_view in(bytes);
+        const auto result = decodeExpression(in);
+
+        BOOST_TEST_REQUIRE(result.has_value());
+        BOOST_TEST(in.empty());
+
+        return *result;
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestCacheCodec, CacheCodecFixture)
+
+BOOST_AUTO_TEST_CASE(leafs)
+{
+    const BasePtr positive = Symbol::createPositive("p");
+    const BasePtr indexed = Symbol::create(Name{"x", "1", "2"});
+    const BasePtr fraction = Numeric::create(Int("123456789012345678901234567890"), 7);
+
+    BOOST_CHECK_EQUAL(a, roundTrip(a));
+    BOOST_CHECK_EQUAL(positive, roundTrip(positive));
+    BOOST_CHECK_EQUAL(indexed, roundTrip(indexed));
+    BOOST_CHECK_EQUAL(fraction, roundTrip(fraction));
+    BOOST_CHECK_EQUAL(pi, roundTrip(pi));
+    BOOST_CHECK_EQUAL(Constant::createE(), roundTrip(Constant::createE()));
+    BOOST_TEST(isUndefined(*roundTrip(undefined)));
+}
+
+BOOST_AUTO_TEST_CASE(floatingPointNumber)
+{
+    const BasePtr number = Numeric::create(0.1234567891234);
+
+    BOOST_TEST(number->isEqual(*roundTrip(number)));
+}
+
+BOOST_AUTO_TEST_CASE(composites)
+{
+    const BasePtr sum = Sum::create(a, Product::create(two, b, Power::sqrt(c)));
+    const BasePtr functions =
+      Product::create(Trigonometric::createSin(a), Logarithm::create(b), Trigonometric::createAtan2(c, d));
+
+    BOOST_CHECK_EQUAL(sum, roundTrip(sum));
+    BOOST_CHECK_EQUAL(functions, roundTrip(functions));
+}
+
+BOOST_AUTO_TEST_CASE(temporarySymbolNotEncodable)
+{
+    std::string bytes;
+
+    BOOST_TEST(!encode(*Sum::create(a, Symbol::createTmpSymbol()), bytes));
+}
+
+BOOST_AUTO_TEST_CASE(truncatedInput)
+{
+    std::string bytes;
+
+    encode(*Product::create(a, Sum::create(b, c)), bytes);
+    bytes.pop_back();
+
+    std::string_view in(bytes);
+
+    BOOST_TEST(!decodeExpression(in).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(deeplyNestedInput)
+{
+    std::string bytes;
+
+    for (int i = 0; i < 1000000; ++i) {
+        bytes.push_back(static_cast<char>(Base::Kind::POWER));
+        detail::writeVarint(2, bytes);
+    }
+
+    std::string_view in(bytes);
+
+    BOOST_TEST(!decodeExpression(in).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(operandsInNonCanonicalOrder)
+{
+    std::string bytes;
+
+    bytes.push_back(static_cast<char>(Base::Kind::SUM));
+    detail::writeVarint(2, bytes);
+    encode(*b, bytes);
+    encode(*a, bytes);
+
+    std::string_view in(bytes);
+
+    BOOST_TEST(!decodeExpression(in).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(nestedSumInSum)
+{
+    std::string bytes;
+
+    bytes.push_back(static_cast<char>(Base::Kind::SUM));
+    detail::writeVarint(2, bytes);
+    encode(*a, bytes);
+    encode(*Sum::create(b, c), bytes);
+
+    std::string_view in(bytes);
+
+    BOOST_TEST(!decodeExpression(in).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(varintRoundTrip)
+{
+    std::string bytes;
+
+    detail::writeVarint(300, bytes);
+    detail::writeVarint(0, bytes);
+
+    std::string_view in(bytes);
+
+    BOOST_CHECK_EQUAL(3, bytes.size());
+    BOOST_CHECK_EQUAL(300, detail::readVarint(in).value_or(0));
+    BOOST_CHECK_EQUAL(0, detail::readVarint(in).value_or(1));
+    BOOST_TEST(!detail::readVarint(in).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(overlongVarint)
+{
+    std::string bytes;
+
+    detail::writeVarint(std::numeric_limits<std::uint64_t>::max(), bytes);
+
+    std::string_view in(bytes);
+
+    BOOST_CHECK_EQUAL(10, bytes.size());
+    BOOST_CHECK_EQUAL(std::numeric_limits<std::uint64_t>::max(), detail::readVarint(in).value_or(0));
+
+    bytes.back() = 2;
+    in = bytes;
+
+    BOOST_TEST(!detail::readVarint(in).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(stableHashReferenceValues)
+{
+    BOOST_CHECK_EQUAL(14695981039346656037u, stableHash(""));
+    BOOST_CHECK_EQUAL(0xaf63dc4c8601ec8cu, stableHash("a"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
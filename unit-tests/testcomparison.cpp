@@ -163,6 +163,48 @@ BOOST_AUTO_TEST_CASE(equalContainer)
     BOOST_TEST(areEqual(container, container));
 }
 
+BOOST_AUTO_TEST_CASE(equalSumsShareInstance)
+{
+    const BasePtr s1 = Sum::create(a, Product::create(two, b), Power::sqrt(c));
+    const BasePtr s2 = Sum::create(Power::sqrt(c), a, Product::create(b, two));
+
+    BOOST_TEST(s1->isInterned());
+    BOOST_CHECK_EQUAL(s1.get(), s2.get());
+}
+
+BOOST_AUTO_TEST_CASE(equalFunctionsShareInstance)
+{
+    const BasePtr sin1 = Trigonometric::createSin(Sum::create(a, b));
+    const BasePtr sin2 = Trigonometric::createSin(Sum::create(b, a));
+
+    BOOST_CHECK_EQUAL(sin1.get(), sin2.get());
+}
+
+BOOST_AUTO_TEST_CASE(recreationAfterRelease)
+{
+    BasePtr sum = Sum::create(a, Trigonometric::createCos(c));
+    const BasePtr clone = sum->clone();
+
+    BOOST_CHECK_EQUAL(sum.get(), clone.get());
+
+    sum.reset();
+
+    BOOST_TEST(clone->isEqual(*Sum::create(Trigonometric::createCos(c), a)));
+}
+
+BOOST_AUTO_TEST_CASE(doubleNumericsNotInterned)
+{
+    const BasePtr n1 = Numeric::create(1.23456789);
+    const BasePtr n2 = Numeric::create(1.23456789 + 1.e-15);
+    const BasePtr s1 = Sum::create(a, n1);
+    const BasePtr s2 = Sum::create(a, n2);
+
+    BOOST_TEST(!n1->isInterned());
+    BOOST_TEST(!s1->isInterned());
+    BOOST_TEST(s1.get() != s2.get());
+    BOOST_TEST(s1->isEqual(*s2));
+}
+
 BOOST_AUTO_TEST_CASE(differentContainer)
 {
     BasePtrList c1{three, four, a};
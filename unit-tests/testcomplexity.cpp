@@ -96,4 +96,15 @@ BOOST_AUTO_TEST_CASE(largerSum)
     BOOST_CHECK_EQUAL(5 + 15 + 5 + 3 + 11 + 16 + 11 + 4, sum->complexity());
 }
 
+BOOST_AUTO_TEST_CASE(repeatedRequestOfSharedSubexpression)
+{
+    const BasePtr pow = Power::create(Sum::create(a, b), c);
+    const unsigned first = pow->complexity();
+    const BasePtr product = Product::create(pow, d);
+
+    BOOST_CHECK_EQUAL(5 + 5 + 5 + 5 + 2 * 5, first);
+    BOOST_CHECK_EQUAL(first, pow->complexity());
+    BOOST_CHECK_EQUAL(5 + first + 5, product->complexity());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
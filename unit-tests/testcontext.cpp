@@ -0,0 +1,124 @@
+#include <thread>
+#include "cache.h"
+#include "context.h"
+#include "options.h"
+#include "tsymtests.h"
+
+using namespace tsym;
+
+struct ContextFixture {
+    Context context;
+    RegisteredCache<int, int> cache{"test"};
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestContext, ContextFixture)
+
+BOOST_AUTO_TEST_CASE(globalContextWithoutSelection)
+{
+    BOOST_CHECK_EQUAL(&Context::global(), &Context::current());
+}
+
+BOOST_AUTO_TEST_CASE(selectionRestoresPreviousContext)
+{
+    Context inner;
+
+    {
+        const Context::Selection outerSelection(context);
+
+        {
+            const Context::Selection innerSelection(inner);
+
+            BOOST_CHECK_EQUAL(&inner, &Context::current());
+        }
+
+        BOOST_CHECK_EQUAL(&context, &Context::current());
+    }
+
+    BOOST_CHECK_EQUAL(&Context::global(), &Context::current());
+}
+
+BOOST_AUTO_TEST_CASE(optionsIsolatedFromGlobalContext)
+{
+    const Int globalResolution = options::getMaxPrimeResolution();
+
+    context.setMaxPrimeResolution(10);
+
+    BOOST_CHECK_EQUAL(globalResolution, options::getMaxPrimeResolution());
+    BOOST_CHECK_EQUAL(10, context.run([]() { return options::getMaxPrimeResolution(); }));
+}
+
+BOOST_AUTO_TEST_CASE(equalOptionsShareInternedValue)
+{
+    Context other;
+
+    context.setMaxPrimeResolution(12345);
+    other.setMaxPrimeResolution(12345);
+
+    BOOST_CHECK_EQUAL(&context.primeResolution(), &other.primeResolution());
+    BOOST_CHECK_EQUAL(12345, context.primeResolution().limit);
+    BOOST_CHECK_EQUAL(&Context::global().primeResolution(), &options::maxPrimeResolution());
+}
+
+BOOST_AUTO_TEST_CASE(cacheEntriesIsolatedFromGlobalContext)
+{
+    cache.insert(1, 10);
+
+    context.run([this]() {
+        BOOST_TEST(!cache.find(1).has_value());
+        cache.insert(2, 20);
+    });
+
+    BOOST_TEST(!cache.find(2).has_value());
+    BOOST_TEST(cache.find(1).has_value());
+    BOOST_TEST(context.run([this]() { return cache.find(2).has_value(); }));
+}
+
+BOOST_AUTO_TEST_CASE(clearOnlyAffectsOwnEntries)
+{
+    cache.insert(1, 10);
+    context.run([this]() { cache.insert(1, 11); });
+
+    context.clearCaches();
+
+    BOOST_TEST(!context.run([this]() { return cache.find(1).has_value(); }));
+    BOOST_CHECK_EQUAL(10, cache.find(1).value_or(0));
+}
+
+BOOST_AUTO_TEST_CASE(zeroCapacityDisablesCachingInContext)
+{
+    context.setCacheCapacity(0);
+
+    context.run([this]() { cache.insert(1, 10); });
+    cache.insert(2, 20);
+
+    BOOST_TEST(!context.run([this]() { return cache.find(1).has_value(); }));
+    BOOST_TEST(cache.find(2).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(layersRemovedWithCache)
+{
+    std::size_t cacheId = 0;
+
+    {
+        RegisteredCache<int, int> local{"local"};
+
+        cacheId = local.id();
+        context.run([&local]() { local.insert(1, 10); });
+
+        BOOST_TEST(detail::findContextLayer(context, cacheId) != nullptr);
+    }
+
+    BOOST_TEST(detail::findContextLayer(context, cacheId) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(contextSharedBetweenThreads, *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    std::thread writer([this]() { context.run([this]() { cache.insert(1, 10); }); });
+
+    writer.join();
+
+    BOOST_CHECK_EQUAL(10, context.run([this]() { return cache.find(1).value_or(0); }));
+    BOOST_TEST(!cache.find(1).has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
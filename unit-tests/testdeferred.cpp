@@ -0,0 +1,101 @@
+#include <thread>
+#include <vector>
+#include "deferred.h"
+#include "functions.h"
+#include "tsymtests.h"
+#include "var.h"
+
+using namespace tsym;
+
+struct DeferredFixture {
+    const Var a = Var("a");
+    const Var b = Var("b");
+    const Var c = Var("c");
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestDeferred, DeferredFixture)
+
+BOOST_AUTO_TEST_CASE(leafValue)
+{
+    const DeferredVar deferred(a);
+
+    BOOST_CHECK_EQUAL(a, deferred.get());
+}
+
+BOOST_AUTO_TEST_CASE(sumOfLikeTerms)
+{
+    const DeferredVar sum = DeferredVar(a) + b + 2 * DeferredVar(a) - b;
+
+    BOOST_CHECK_EQUAL(3 * a, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(quotient)
+{
+    const DeferredVar quotient = DeferredVar(a) * b * b / b / pow(DeferredVar(a), 2);
+
+    BOOST_CHECK_EQUAL(b / a, quotient.get());
+}
+
+BOOST_AUTO_TEST_CASE(negation)
+{
+    const DeferredVar negated = -(DeferredVar(a) - b);
+
+    BOOST_CHECK_EQUAL(b - a, negated.get());
+}
+
+BOOST_AUTO_TEST_CASE(equalToEagerConstruction)
+{
+    DeferredVar deferred(0);
+    Var eager;
+
+    for (int i = 1; i < 60; ++i) {
+        const Var coeff(i % 5 - 2, i % 3 + 1);
+        DeferredVar term = DeferredVar(coeff) * pow(DeferredVar(a), i % 4) * (DeferredVar(b) + c);
+
+        term /= pow(DeferredVar(c), i % 2);
+        deferred += term;
+        eager += coeff * pow(a, i % 4) * (b + c) / pow(c, i % 2);
+    }
+
+    BOOST_CHECK_EQUAL(eager, deferred.get());
+}
+
+BOOST_AUTO_TEST_CASE(sharedOperandNotModified)
+{
+    DeferredVar sum = DeferredVar(a) + b;
+    const DeferredVar copy = sum;
+
+    sum += c;
+
+    BOOST_CHECK_EQUAL(a + b, copy.get());
+    BOOST_CHECK_EQUAL(a + b + c, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(appendAfterEvaluation)
+{
+    DeferredVar sum = DeferredVar(a) + b;
+
+    BOOST_CHECK_EQUAL(a + b, sum.get());
+
+    sum += c;
+
+    BOOST_CHECK_EQUAL(a + b + c, sum.get());
+}
+
+BOOST_AUTO_TEST_CASE(concurrentEvaluation)
+{
+    const DeferredVar shared = pow(DeferredVar(a) + b, 2) * c - c * pow(b + DeferredVar(a), 2);
+    std::vector<std::thread> threads;
+    std::vector<Var> results(4);
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+        threads.emplace_back([&shared, &results, i]() { results[i] = shared.get(); });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& result : results)
+        BOOST_CHECK_EQUAL(0, result);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+#include <functional>
+#include "flatcachetable.h"
+#include "tsymtests.h"
+
+using namespace tsym;
+
+struct FlatCacheTableFixture {
+    using Table = detail::FlatCacheTable<int, int, std::equal_to<int>>;
+
+    Table table;
+
+    int valueOf(int key, std::size_t hash)
+    {
+        const auto* entry = table.find(key, hash);
+
+        return entry == nullptr ? -1 : entry->value;
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestFlatCacheTable, FlatCacheTableFixture)
+
+BOOST_AUTO_TEST_CASE(lookupInEmptyTable)
+{
+    BOOST_TEST(table.find(1, 1) == nullptr);
+    BOOST_CHECK_EQUAL(0, table.size());
+}
+
+BOOST_AUTO_TEST_CASE(emplaceOfExistingKey)
+{
+    const auto first = table.tryEmplace(1, 1, 10);
+    const auto second = table.tryEmplace(1, 1, 20);
+
+    BOOST_TEST(first.second);
+    BOOST_TEST(!second.second);
+    BOOST_CHECK_EQUAL(first.first, second.first);
+    BOOST_CHECK_EQUAL(10, valueOf(1, 1));
+    BOOST_CHECK_EQUAL(1, table.size());
+}
+
+BOOST_AUTO_TEST_CASE(growthKeepsEntries)
+{
+    for (int i = 0; i < 1000; ++i)
+        table.tryEmplace(i, std::hash<int>{}(i), -i);
+
+    BOOST_CHECK_EQUAL(1000, table.size());
+
+    for (int i = 0; i < 1000; ++i)
+        BOOST_CHECK_EQUAL(-i, valueOf(i, std::hash<int>{}(i)));
+}
+
+BOOST_AUTO_TEST_CASE(eraseWithinCollisionChain)
+{
+    /* Identical hashes put all keys into a single probing sequence: */
+    for (int i = 0; i < 10; ++i)
+        table.tryEmplace(i, 42, i);
+
+    table.erase(table.tryEmplace(3, 42, 0).first);
+    table.erase(table.tryEmplace(0, 42, 0).first);
+
+    BOOST_CHECK_EQUAL(8, table.size());
+    BOOST_CHECK_EQUAL(-1, valueOf(3, 42));
+    BOOST_CHECK_EQUAL(-1, valueOf(0, 42));
+
+    for (int i : {1, 2, 4, 5, 6, 7, 8, 9})
+        BOOST_CHECK_EQUAL(i, valueOf(i, 42));
+}
+
+BOOST_AUTO_TEST_CASE(indexOfErasedEntryReused)
+{
+    const auto index = table.tryEmplace(1, 1, 10).first;
+
+    table.erase(index);
+
+    BOOST_CHECK_EQUAL(index, table.tryEmplace(2, 2, 20).first);
+    BOOST_CHECK_EQUAL(20, valueOf(2, 2));
+}
+
+BOOST_AUTO_TEST_CASE(victimNotReferencedSinceLastSweep)
+{
+    const auto first = table.tryEmplace(1, 1, 10).first;
+    const auto second = table.tryEmplace(2, 2, 20).first;
+
+    table.find(1, 1);
+
+    BOOST_CHECK_EQUAL(second, table.victim(Table::noIndex));
+    BOOST_CHECK_EQUAL(first, table.victim(second));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
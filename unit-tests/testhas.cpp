@@ -169,4 +169,13 @@ BOOST_AUTO_TEST_CASE(argOfFunction)
     BOOST_TEST(fct->has(*arg));
 }
 
+BOOST_AUTO_TEST_CASE(symbolBloomOfComposites)
+{
+    const BasePtr product = Product::create(a, Power::create(b, c));
+
+    BOOST_TEST((twoPiAbProduct->symbolBloom() & ~product->symbolBloom()) == 0);
+    BOOST_TEST(Sum::create(two, pi)->symbolBloom() == 0);
+    BOOST_TEST(product->mightHave(*Sum::create(a, c)));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
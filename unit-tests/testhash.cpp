@@ -174,4 +174,13 @@ BOOST_AUTO_TEST_CASE(sumAndProductEqualOperands)
     BOOST_TEST(sumHash != productHash);
 }
 
+BOOST_AUTO_TEST_CASE(storedHashOfComposite)
+{
+    const BasePtr sum = Sum::create(a, Product::create(b, Power::sqrt(c)), Trigonometric::createSin(d));
+
+    BOOST_CHECK_EQUAL(sum->hash(), hash(sum));
+    BOOST_CHECK_EQUAL(
+      sum->hash(), hash(Sum::create(Trigonometric::createSin(d), Product::create(Power::sqrt(c), b), a)));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -132,4 +132,23 @@ BOOST_AUTO_TEST_CASE(streamOperator)
     BOOST_CHECK_EQUAL("abc_d", stream.str());
 }
 
+BOOST_AUTO_TEST_CASE(orderKeyConsistentWithComparison)
+{
+    const Name names[] = {{"a"}, {"ab"}, {"b"}, {"B"}, {"abcdefgh"}, {"\xc3\xa4"}, {"z", "1"}, {"alpha"}};
+
+    for (const auto& lhs : names)
+        for (const auto& rhs : names)
+            if (orderKey(lhs) != orderKey(rhs))
+                BOOST_CHECK_EQUAL(lhs < rhs, orderKey(lhs) < orderKey(rhs));
+}
+
+BOOST_AUTO_TEST_CASE(orderKeyOfLongNamesWithEqualPrefix)
+{
+    const Name lhs{"abcdefghi"};
+    const Name rhs{"abcdefghj"};
+
+    BOOST_CHECK_EQUAL(orderKey(lhs), orderKey(rhs));
+    BOOST_CHECK_EQUAL(orderKey(Name{"a", "1"}), orderKey(Name{"a", "2"}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,6 +1,9 @@
 
+#include <atomic>
 #include <cmath>
 #include <limits>
+#include <thread>
+#include <vector>
 #include "basefct.h"
 #include "baseptrlistfct.h"
 #include "constant.h"
@@ -932,4 +935,32 @@ BOOST_AUTO_TEST_CASE(numericallyEvaluableExpToUndefined)
     BOOST_TEST(isUndefined(*res));
 }
 
+BOOST_AUTO_TEST_CASE(concurrentNumericEvaluationOfFreshNode)
+{
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 100; ++i) {
+        const BasePtr pow = Power::create(pi, Numeric::create(1, 1000 + i));
+        std::atomic<bool> start{false};
+        std::atomic<int> failures{0};
+
+        threads.clear();
+
+        for (int j = 0; j < 8; ++j)
+            threads.emplace_back([&pow, &start, &failures]() {
+                while (!start.load())
+                    ;
+                if (!pow->numericEval())
+                    ++failures;
+            });
+
+        start.store(true);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        BOOST_CHECK_EQUAL(0, failures.load());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -48,6 +48,13 @@ BOOST_AUTO_TEST_CASE(typeString)
     BOOST_CHECK_EQUAL(expected, ptr->typeStr());
 }
 
+BOOST_AUTO_TEST_CASE(kindTag)
+{
+    const BasePtr ptr = Product::create(a, b);
+
+    BOOST_TEST((ptr->kind() == Base::Kind::PRODUCT));
+}
+
 BOOST_AUTO_TEST_CASE(undefinedToUndefined)
 {
     const BasePtr p = Product::create(undefined, a);
@@ -1042,4 +1049,38 @@ BOOST_AUTO_TEST_CASE(dontAlwaysContractZeroSumExp)
     BOOST_TEST(result->operands().size() > 1);
 }
 
+BOOST_AUTO_TEST_CASE(manyFactorsEqualToPairwiseSimplification)
+{
+    const BasePtr aPos = Symbol::createPositive("a");
+    const BasePtrList factors{a, b, Sum::create(c, d), Power::create(aPos, half), Power::create(aPos, minusOneHalf),
+      Numeric::create(-3, 4), Power::create(e, two), Trigonometric::createAtan(f)};
+    BasePtrList collected;
+
+    for (int i = 0; i < 40; ++i)
+        collected.push_back(
+          Power::create(factors[static_cast<std::size_t>(5 * i) % factors.size()], Numeric::create(i % 3 - 1)));
+
+    collected.push_back(Product::create(Numeric::create(7), b, Power::create(c, g)));
+
+    BasePtr expected = collected.front();
+
+    for (auto it = std::next(cbegin(collected)); it != cend(collected); ++it)
+        expected = Product::create(expected, *it);
+
+    BOOST_CHECK_EQUAL(expected, Product::create(collected));
+}
+
+BOOST_AUTO_TEST_CASE(manyFactorsCancelling)
+{
+    BasePtrList factors;
+
+    for (const auto& factor : {a, b, c, d, e, f, g, h})
+        factors.push_back(factor);
+
+    for (const auto& factor : {a, b, c, d, e, f, g, h})
+        factors.push_back(Power::oneOver(factor));
+
+    BOOST_CHECK_EQUAL(one, Product::create(factors));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
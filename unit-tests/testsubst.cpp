@@ -295,4 +295,12 @@ BOOST_AUTO_TEST_CASE(mixedTerm)
     BOOST_CHECK_EQUAL(expected, res);
 }
 
+BOOST_AUTO_TEST_CASE(absentSymbolKeepsInstance)
+{
+    const BasePtr orig = Sum::create(Product::create(two, a, b), Trigonometric::createSin(Power::sqrt(c)));
+    const BasePtr res = orig->subst(*d, ten);
+
+    BOOST_CHECK_EQUAL(orig.get(), res.get());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
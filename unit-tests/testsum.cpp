@@ -33,6 +33,13 @@ BOOST_AUTO_TEST_CASE(typeString)
     BOOST_CHECK_EQUAL(expected, ptr->typeStr());
 }
 
+BOOST_AUTO_TEST_CASE(kindTag)
+{
+    const BasePtr ptr = Sum::create(a, b);
+
+    BOOST_TEST((ptr->kind() == Base::Kind::SUM));
+}
+
 BOOST_AUTO_TEST_CASE(undefinedToUndefined)
 {
     const BasePtr p = Sum::create(undefined, a);
@@ -502,4 +509,37 @@ BOOST_AUTO_TEST_CASE(nonContractableSinCosSquareNonEqualPrefactor)
     BOOST_CHECK_EQUAL(s1, result->operands().back());
 }
 
+BOOST_AUTO_TEST_CASE(manySummandsEqualToPairwiseSimplification)
+{
+    const BasePtrList terms{a, b, Power::create(a, two), Product::create(b, c), Power::create(c, Numeric::create(1, 3)),
+      Trigonometric::createSin(d), one};
+    BasePtrList summands;
+
+    for (int i = 0; i < 60; ++i)
+        summands.push_back(Product::create(
+          Numeric::create(i % 5 - 2, i % 3 + 1), terms[static_cast<std::size_t>(7 * i) % terms.size()]));
+
+    summands.push_back(Sum::create(Product::create(Numeric::create(-17), a), e));
+
+    BasePtr expected = summands.front();
+
+    for (auto it = std::next(cbegin(summands)); it != cend(summands); ++it)
+        expected = Sum::create(expected, *it);
+
+    BOOST_CHECK_EQUAL(expected, Sum::create(summands));
+}
+
+BOOST_AUTO_TEST_CASE(manySummandsCancelling)
+{
+    BasePtrList summands;
+
+    for (const auto& summand : {a, b, c, d, e, f, g, h})
+        summands.push_back(summand);
+
+    for (const auto& summand : {a, b, c, d, e, f, g, h})
+        summands.push_back(Product::create(Numeric::mOne(), summand));
+
+    BOOST_CHECK_EQUAL(zero, Sum::create(summands));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
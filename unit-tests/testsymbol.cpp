@@ -1,4 +1,6 @@
 
+#include <thread>
+#include <vector>
 #include "basefct.h"
 #include "fixtures.h"
 #include "number.h"
@@ -49,4 +51,35 @@ BOOST_AUTO_TEST_CASE(nameReservedForTemporaries, noLogs())
     BOOST_TEST(tmp->name() != name);
 }
 
+BOOST_AUTO_TEST_CASE(temporaryIdsNotReused)
+{
+    BasePtr first = Symbol::createTmpSymbol();
+    const BasePtr second = Symbol::createTmpSymbol();
+
+    first.reset();
+
+    BOOST_TEST(Symbol::createTmpSymbol() != second);
+}
+
+BOOST_AUTO_TEST_CASE(concurrentCreation)
+{
+    std::vector<BasePtr> named(8);
+    std::vector<BasePtr> tmp(8);
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < named.size(); ++i)
+        threads.emplace_back([&named, &tmp, i]() {
+            named[i] = Symbol::create("concurrent");
+            tmp[i] = Symbol::createTmpSymbol();
+        });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (std::size_t i = 1; i < named.size(); ++i) {
+        BOOST_TEST(named[i] == named.front());
+        BOOST_TEST(tmp[i] != tmp.front());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,12 +1,17 @@
 
 #include <boost/range/algorithm/find.hpp>
+#include <boost/range/algorithm/find_if.hpp>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include "base.h"
 #include "baseptr.h"
+#include "cache.h"
 #include "constants.h"
+#include "context.h"
 #include "fixtures.h"
 #include "functions.h"
 #include "name.h"
@@ -336,6 +341,48 @@ BOOST_AUTO_TEST_CASE(subtractDifferentSymbolsOperator)
     BOOST_CHECK_EQUAL(a - b, res);
 }
 
+BOOST_AUTO_TEST_CASE(compoundOperatorsWithItself)
+{
+    Var res(a);
+
+    res += res;
+    BOOST_CHECK_EQUAL(2 * a, res);
+
+    res *= res;
+    BOOST_CHECK_EQUAL(4 * a * a, res);
+
+    res -= res;
+    BOOST_CHECK_EQUAL(zero, res);
+
+    res = a;
+    res += std::move(res);
+    BOOST_CHECK_EQUAL(2 * a, res);
+
+    res /= std::move(res);
+    BOOST_CHECK_EQUAL(1, res);
+}
+
+BOOST_AUTO_TEST_CASE(temporaryOperandsMovedIntoResult)
+{
+    const Var expected = a * b - c / d;
+    Var lhs = a * b;
+    Var rhs = c / d;
+    Var res = std::move(lhs) - std::move(rhs);
+
+    BOOST_CHECK_EQUAL(expected, res);
+    BOOST_CHECK(!lhs.get());
+    BOOST_CHECK(!rhs.get());
+
+    lhs = a;
+    rhs = b;
+    res = lhs * (rhs + c);
+    res += std::move(rhs);
+
+    BOOST_CHECK_EQUAL(a * (b + c) + b, res);
+    BOOST_CHECK_EQUAL(a, lhs);
+    BOOST_CHECK(!rhs.get());
+}
+
 BOOST_AUTO_TEST_CASE(multiplyDifferentSymbolsOperator)
 {
     Var res(a);
@@ -1139,4 +1186,150 @@ BOOST_AUTO_TEST_CASE(differentHashes)
     BOOST_TEST(std::hash<Var>{}(a) != std::hash<Var>{}(2 * a));
 }
 
+BOOST_AUTO_TEST_CASE(concurrentSimplification)
+{
+    const auto compute = [this]() { return simplify((a + b) * (a - b) / (a * a - b * b) + tsym::pow(c + d, 3)); };
+    const Var expected = compute();
+    std::vector<Var> results(8);
+    std::vector<std::thread> threads;
+
+    clearRegisteredCaches();
+
+    for (auto& result : results)
+        threads.emplace_back([&result, &compute]() {
+            for (int i = 0; i < 20; ++i)
+                result = compute();
+        });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& result : results)
+        BOOST_CHECK_EQUAL(expected, result);
+}
+
+BOOST_AUTO_TEST_CASE(handleMovedOutOfTemporary)
+{
+    Var tmp = a * b;
+    const Base* const expected = tmp.get().get();
+    const Var::BasePtr handle = std::move(tmp).get();
+
+    BOOST_CHECK_EQUAL(expected, handle.get());
+    BOOST_TEST(!tmp.get()); // NOLINT: the moved-from state is what's tested here
+}
+
+BOOST_AUTO_TEST_CASE(chainedSumLikeStepwise)
+{
+    Var stepwise(a);
+
+    stepwise += b;
+    stepwise -= c;
+    stepwise += 2 * a;
+
+    BOOST_CHECK_EQUAL(stepwise, a + b - c + 2 * a);
+    BOOST_CHECK_EQUAL(stepwise, (a + b) + (2 * a - c));
+    BOOST_CHECK_EQUAL(-stepwise, -(a + b - c + 2 * a));
+}
+
+BOOST_AUTO_TEST_CASE(chainedProductLikeStepwise)
+{
+    Var stepwise(a);
+
+    stepwise *= b;
+    stepwise /= c;
+    stepwise *= a;
+
+    BOOST_CHECK_EQUAL(stepwise, a * b / c * a);
+    BOOST_CHECK_EQUAL(stepwise, (a * b) * (a / c));
+    BOOST_CHECK_EQUAL(Var::Type::PRODUCT, (a * b * c).type());
+}
+
+BOOST_AUTO_TEST_CASE(chainedConstantFactorsLikeStepwise)
+/* Products of numeric powers are contracted depending on the order of the factors, hence the
+ * result of stepwise multiplication must be kept: */
+{
+    Var stepwise(sqrtThree);
+
+    stepwise *= tsym::sqrt(17);
+    stepwise *= tsym::pow(17, Var(2, 3));
+    stepwise *= sqrtTwo;
+
+    BOOST_CHECK_EQUAL(stepwise, sqrtThree * tsym::sqrt(17) * tsym::pow(17, Var(2, 3)) * sqrtTwo);
+}
+
+BOOST_AUTO_TEST_CASE(chainedSumWithoutIntermediateCacheEntries,
+  *boost::unit_test::enable_if<!detail::threadLocalCaches>())
+{
+    const Var x("chainedX");
+    const auto entries = []() {
+        const auto all = registeredCacheStats();
+
+        return boost::find_if(all, [](const auto& stats) { return stats.name == "simplifySum"; })->entries;
+    };
+
+    clearRegisteredCaches();
+
+    const Var sum = x + a + b + c + d;
+
+    BOOST_CHECK_EQUAL(Var::Type::SUM, sum.type());
+    BOOST_CHECK_EQUAL(1, entries());
+}
+
+BOOST_AUTO_TEST_CASE(chainedResultUsableAsVar)
+{
+    auto sum = a + b;
+    const bool flag = sum.type() == Var::Type::SUM;
+    const Var conditional = flag ? a + b : a * b;
+
+    sum += c;
+    BOOST_CHECK_EQUAL(a + b + c, sum);
+
+    sum = d;
+    BOOST_CHECK_EQUAL(d, sum);
+
+    BOOST_CHECK_EQUAL(a + b, conditional);
+}
+
+BOOST_AUTO_TEST_CASE(copiesOfChainedResult)
+{
+    Var first = a + b;
+    const Var copy = first;
+
+    first = std::move(first) + c;
+
+    BOOST_CHECK_EQUAL(a + b + c, first);
+    BOOST_CHECK_EQUAL(Var::Type::SUM, copy.type());
+    BOOST_CHECK_EQUAL(2, operands(copy).size());
+}
+
+BOOST_AUTO_TEST_CASE(concurrentEvaluationOfChainedResult)
+{
+    const Var sum = a * b + c + d - e;
+    const Var expected = a * b + c + d - e;
+    std::vector<std::thread> threads;
+    std::vector<Var::BasePtr> results(8);
+
+    for (auto& result : results)
+        threads.emplace_back([&result, &sum]() { result = sum.get(); });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& result : results)
+        BOOST_CHECK_EQUAL(expected, Var(result));
+}
+
+BOOST_AUTO_TEST_CASE(chainedResultSimplifiedInCreatingContext)
+/* 2^(1/3)*3^(2/3) = 18^(1/3) only if 18 doesn't exceed the limit for prime factorization: */
+{
+    Context context;
+
+    context.setMaxPrimeResolution(10);
+
+    const Var product = context.run([]() { return tsym::pow(2, Var(1, 3)) * tsym::pow(3, Var(2, 3)); });
+
+    BOOST_CHECK_EQUAL(Var::Type::PRODUCT, product.type());
+    BOOST_CHECK_EQUAL(Var::Type::POWER, (tsym::pow(2, Var(1, 3)) * tsym::pow(3, Var(2, 3))).type());
+}
+
 BOOST_AUTO_TEST_SUITE_END()